@@ -30,4 +30,15 @@ fi
 mkdir -p embuild
 cd embuild
 emcmake cmake .. -DPLATFORM=Web -DCMAKE_BUILD_TYPE=Release
-cmake --build . --parallel
\ No newline at end of file
+cmake --build . --parallel
+cd ..
+
+# the same without WebAssembly SIMD, for the browsers lacking it; index.html picks the build at load time
+mkdir -p embuild-nosimd
+cd embuild-nosimd
+emcmake cmake .. -DPLATFORM=Web -DCMAKE_BUILD_TYPE=Release -DOPTDEMO_WASM_SIMD=OFF
+cmake --build . --parallel
+cd ..
+
+cp embuild-nosimd/optdemo-nosimd.* embuild/
+cp misc/index.html embuild/
@@ -8,11 +8,24 @@
 #include "Application.h"
 #include "Helpers.h"
 #include "Stage.h"
+#include "PerfCounters.h"
+#include "Trace.h"
+#include "ThreadPool.h"
+#include "Checkpoint.h"
 
 #include "raylib.h"
 
+#ifdef __EMSCRIPTEN__
+	#include <emscripten/emscripten.h>
+#endif
+
 bool Application::Init(int argc, char** argv) {
-	// for future use
+	// create the counters on the main thread, before any worker may record into them
+	PerfCounters::Instance();
+	// start the evaluation workers from the main thread (the web build takes them from the pre-spawned pthread pool)
+	ThreadPool::Instance();
+	// the checkpoints are submitted from the optimizer thread, create the writer before
+	CheckpointWriter::Instance();
 	return true;
 }
 
@@ -21,56 +34,96 @@ int Application::Run() {
 	// antialiasing
 	SetConfigFlags(FLAG_MSAA_4X_HINT);
 
-	TWindow_Guard window(Window_Width, Window_Height, "OptVisualDemo");
+	mWindow = std::make_unique<TWindow_Guard>(Window_Width, Window_Height, "OptVisualDemo");
 
-	TFont_Ptr fnt = std::make_shared<TFont>("assets/OpenSans.ttf");
+	mFont = std::make_shared<TFont>("assets/OpenSans.ttf");
 
+#ifdef __EMSCRIPTEN__
+	// let the browser call the frames (no blocking loop, so no ASYNCIFY is needed); the runtime stays alive after main returns
+	emscripten_set_main_loop_arg(&Application::Frame_Callback, this, 0, false);
+#else
 	// main loop
-	while (!WindowShouldClose())
-	{
-		// handle stage changes
-		if (mRequested_Stage != NStage::None) {
-			if (mStage) {
-				mStage->On_Leave();
-				mStage.reset();
-			}
-
-			switch (mRequested_Stage) {
-				case NStage::Menu:
-					mStage = std::make_unique<MenuStage>();
-					break;
-				case NStage::Experiment:
-					mStage = std::make_unique<ExperimentStage>(mRequested_Experiment);
-					break;
-				default:
-					break;
-			}
-
-			if (mStage) {
-				mStage->On_Enter();
-				mCurrent_Stage = mRequested_Stage;
-			}
-			else {
-				mCurrent_Stage = NStage::None;
-			}
-
-			mRequested_Stage = NStage::None;
-		}
+	while (!WindowShouldClose()) {
+		Frame();
+	}
+
+	Shutdown();
+#endif
+
+	return 0;
+}
 
-		TDrawing_Guard draw;
+#ifdef __EMSCRIPTEN__
+void Application::Frame_Callback(void* arg) {
+	static_cast<Application*>(arg)->Frame();
+}
+#endif
+
+void Application::Frame() {
+	TRACE_SCOPE("Application::Frame");
+
+#ifdef OPTDEMO_TRACING
+	if (IsKeyPressed(KEY_F9)) {
+		Tracer::Dump_Chrome_Trace("trace.json");
+	}
+#endif
+
+	// handle stage changes
+	if (mRequested_Stage != NStage::None) {
+		if (mStage) {
+			mStage->On_Leave();
+			mStage.reset();
+		}
 
-		ClearBackground(RAYWHITE);
+		switch (mRequested_Stage) {
+			case NStage::Menu:
+				mStage = std::make_unique<MenuStage>();
+				break;
+			case NStage::Experiment:
+				mStage = std::make_unique<ExperimentStage>(mRequested_Experiment);
+				break;
+			default:
+				break;
+		}
 
 		if (mStage) {
-			mStage->On_Update(GetFrameTime());
-			mStage->On_Render();
+			mStage->On_Enter();
+			mCurrent_Stage = mRequested_Stage;
+		}
+		else {
+			mCurrent_Stage = NStage::None;
 		}
+
+		mRequested_Stage = NStage::None;
+	}
+
+	TDrawing_Guard draw;
+
+	ClearBackground(RAYWHITE);
+
+	TPerf_Scope frameScope(NPerf_Counter::Frame);
+
+	if (mStage) {
+		mStage->On_Update(GetFrameTime());
+		mStage->On_Render();
 	}
+}
 
+void Application::Shutdown() {
 	if (mStage) {
 		mStage->On_Leave();
 		mStage.reset();
 	}
 
-	return 0;
+	mOptimization_Worker.Shutdown();
+
+	// the stopped optimization left its checkpoint in the writer queue
+	CheckpointWriter::Instance().Flush();
+
+#ifdef OPTDEMO_TRACING
+	Tracer::Dump_Chrome_Trace("trace.json");
+#endif
+
+	mFont.reset();
+	mWindow.reset();
 }
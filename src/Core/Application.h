@@ -10,6 +10,10 @@
 #include "ObjectAccessor.h"
 #include "Stage.h"
 #include "Experiment.h"
+#include "OptimizationWorker.h"
+#include "Helpers.h"
+
+#include <memory>
 
 constexpr int Window_Width = 1200;
 constexpr int Window_Height = 800;
@@ -25,13 +29,30 @@ class Application : public IObject {
 
 		NExperiment mRequested_Experiment = NExperiment::None;
 
+		// persistent worker for running optimizations
+		OptimizationWorker mOptimization_Worker;
+
+		// window and font live across frames (in the web build, Run returns before the first frame is drawn)
+		std::unique_ptr<TWindow_Guard> mWindow;
+		TFont_Ptr mFont;
+
+		// process a single frame (stage changes, update and render)
+		void Frame();
+		// leave the current stage and stop the workers
+		void Shutdown();
+
+#ifdef __EMSCRIPTEN__
+		// browser main loop callback, arg is the application instance
+		static void Frame_Callback(void* arg);
+#endif
+
 	public:
 		Application() = default;
 		~Application() override = default;
 
 		// Initialize the application (parse args, setup, etc.)
 		bool Init(int argc, char** argv);
-		// Run the main application loop
+		// Run the main application loop; in the web build, the loop is driven by the browser and this returns immediately
 		int Run();
 
 		// Singleton instance accessor
@@ -53,4 +74,9 @@ class Application : public IObject {
 		void Request_Experiment(NExperiment new_experiment) {
 			mRequested_Experiment = new_experiment;
 		}
+
+		// get the optimization worker shared by all experiments
+		OptimizationWorker& Get_Optimization_Worker() {
+			return mOptimization_Worker;
+		}
 };
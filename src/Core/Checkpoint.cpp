@@ -0,0 +1,127 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "Checkpoint.h"
+#include "Serialization.h"
+#include "Trace.h"
+
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <cstring>
+
+namespace {
+	constexpr char Checkpoint_Magic[4] = { 'O', 'V', 'C', 'P' };
+	constexpr uint32_t Checkpoint_Version = 5;
+}
+
+std::vector<uint8_t> TCheckpoint::Serialize(std::span<const uint8_t> experimentData, std::span<const uint8_t> optimizerState) {
+	TBinary_Writer writer;
+	writer.Write_Bytes(Checkpoint_Magic, sizeof(Checkpoint_Magic));
+	writer.Write(Checkpoint_Version);
+	writer.Write_Span(experimentData);
+	writer.Write_Span(optimizerState);
+	return writer.Take();
+}
+
+bool TCheckpoint::Load(const std::string& path, std::string& error) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open()) {
+		error = "Cannot open " + path;
+		return false;
+	}
+
+	const std::vector<uint8_t> contents{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+	TBinary_Reader reader(contents);
+
+	char magic[4];
+	uint32_t version = 0;
+	if (!reader.Read_Bytes(magic, sizeof(magic)) || std::memcmp(magic, Checkpoint_Magic, sizeof(magic)) != 0 || !reader.Read(version) || version != Checkpoint_Version) {
+		error = "Not a checkpoint file (or unsupported version)";
+		return false;
+	}
+
+	if (!reader.Read_Vector(experimentData) || !reader.Read_Vector(optimizerState)) {
+		error = "Truncated checkpoint file";
+		return false;
+	}
+
+	return true;
+}
+
+CheckpointWriter::CheckpointWriter() {
+	mThread = std::jthread([this](std::stop_token stopToken) {
+		Run(stopToken);
+	});
+}
+
+CheckpointWriter::~CheckpointWriter() {
+	// the pending checkpoints are still written before the thread exits
+	mThread.request_stop();
+	mCv.notify_all();
+	mThread = {};
+}
+
+void CheckpointWriter::Submit(const std::string& path, std::vector<uint8_t> data) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPending[path] = std::move(data);
+	}
+	mCv.notify_one();
+}
+
+void CheckpointWriter::Flush() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	mIdle_Cv.wait(lock, [this]() { return mPending.empty() && !mWriting; });
+}
+
+void CheckpointWriter::Run(std::stop_token stopToken) {
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	while (true) {
+		mCv.wait(lock, stopToken, [this]() { return !mPending.empty(); });
+		if (mPending.empty()) {
+			// stop requested and nothing left to write
+			break;
+		}
+
+		auto pending = std::move(mPending);
+		mPending.clear();
+		mWriting = true;
+
+		lock.unlock();
+		for (const auto& [path, data] : pending) {
+			Write_File(path, data);
+		}
+		lock.lock();
+
+		mWriting = false;
+		mIdle_Cv.notify_all();
+	}
+}
+
+bool CheckpointWriter::Write_File(const std::string& path, const std::vector<uint8_t>& data) {
+	TRACE_SCOPE("Checkpoint::Write");
+
+	// write to a temporary file first, so a crash while writing does not destroy the previous checkpoint
+	const std::string tmpPath = path + ".tmp";
+	{
+		std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!out.is_open()) {
+			return false;
+		}
+		out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		if (!out.good()) {
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmpPath, path, ec);
+	return !ec;
+}
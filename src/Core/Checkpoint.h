@@ -0,0 +1,70 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <string>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#include "ObjectAccessor.h"
+
+/**
+ * Checkpoint of an optimization run - the experiment data and the optimizer state (both opaque here)
+ *
+ * File layout: char magic[4] = "OVCP", uint32 version, uint64 experimentData size, experimentData,
+ *              uint64 optimizerState size, optimizerState
+ */
+struct TCheckpoint {
+	std::vector<uint8_t> experimentData;
+	std::vector<uint8_t> optimizerState;
+
+	// compose the file contents from the given parts
+	static std::vector<uint8_t> Serialize(std::span<const uint8_t> experimentData, std::span<const uint8_t> optimizerState);
+
+	// load the checkpoint from the file, returns false and fills error on failure
+	bool Load(const std::string& path, std::string& error);
+};
+
+/**
+ * Writes checkpoint files on a background thread, so the optimizer only pays for the serialization;
+ * a checkpoint still waiting to be written is replaced by a newer one for the same path
+ */
+class CheckpointWriter : public IObject {
+	private:
+		std::mutex mMutex;
+		std::condition_variable_any mCv;
+		std::condition_variable mIdle_Cv;
+
+		// path -> contents of the latest checkpoint not written yet
+		std::map<std::string, std::vector<uint8_t>> mPending;
+		bool mWriting = false;
+
+		std::jthread mThread;
+
+		void Run(std::stop_token stopToken);
+		static bool Write_File(const std::string& path, const std::vector<uint8_t>& data);
+
+	public:
+		CheckpointWriter();
+		~CheckpointWriter() override;
+
+		static CheckpointWriter& Instance() {
+			return CObjectAccessor::get<CheckpointWriter>();
+		}
+
+		// queue the checkpoint to be written
+		void Submit(const std::string& path, std::vector<uint8_t> data);
+
+		// block until all the queued checkpoints are written
+		void Flush();
+};
@@ -0,0 +1,233 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "Dataset.h"
+#include "MappedFile.h"
+
+#include <fstream>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <cctype>
+#include <new>
+
+namespace {
+	constexpr char Binary_Magic[4] = { 'O', 'V', 'D', 'P' };
+	constexpr uint32_t Binary_Version = 1;
+
+	// CSV lines with higher class index are skipped
+	constexpr size_t Max_CSV_Class = 255;
+
+	struct TBinary_Header {
+		char magic[4];
+		uint32_t version;
+		uint32_t classCount;
+		uint32_t reserved;
+	};
+
+	static_assert(sizeof(TBinary_Header) == 16, "Unexpected binary header size");
+	static_assert(sizeof(Vector2) == 2 * sizeof(float), "Vector2 must be tightly packed to be viewed in place");
+
+	// parse a single number from the CSV field, returns false if it's not a number
+	bool Parse_Float(const char*& cur, const char* end, float& value) {
+		while (cur < end && (*cur == ' ' || *cur == '\t')) {
+			cur++;
+		}
+		auto [ptr, ec] = std::from_chars(cur, end, value);
+		if (ec != std::errc()) {
+			return false;
+		}
+		cur = ptr;
+		while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\r')) {
+			cur++;
+		}
+		return true;
+	}
+}
+
+TPoint_Set::TPoint_Set(const TPoint_Set& other) {
+	*this = other;
+}
+
+TPoint_Set& TPoint_Set::operator=(const TPoint_Set& other) {
+	if (this == &other) {
+		return *this;
+	}
+
+	mStorage = other.mStorage;
+	mOwned = other.mOwned;
+	mSize = other.mSize;
+	mData = mStorage ? other.mData : mOwned.data();
+	mRevision++;
+	mReset_Revision++;
+
+	return *this;
+}
+
+void TPoint_Set::Make_Owned() {
+	if (mStorage) {
+		mOwned.assign(mData, mData + mSize);
+		mStorage.reset();
+	}
+}
+
+void TPoint_Set::Assign_View(std::shared_ptr<const void> storage, std::span<const Vector2> points) {
+	mOwned.clear();
+	mOwned.shrink_to_fit();
+	mStorage = std::move(storage);
+	mData = points.data();
+	mSize = points.size();
+	mRevision++;
+	mReset_Revision++;
+}
+
+void TPoint_Set::push_back(const Vector2& point) {
+	Make_Owned();
+	mOwned.push_back(point);
+	mData = mOwned.data();
+	mSize = mOwned.size();
+	mRevision++;
+}
+
+void TPoint_Set::clear() {
+	mStorage.reset();
+	mOwned.clear();
+	mData = mOwned.data();
+	mSize = 0;
+	mRevision++;
+	mReset_Revision++;
+}
+
+bool TDataset::Load(const std::string& path, std::string& error) {
+	std::string ext = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	// a dropped file may be anything, the failure is reported instead of thrown
+	try {
+		if (ext == ".csv") {
+			return Load_CSV(path, error);
+		}
+
+		return Load_Binary(path, error);
+	}
+	catch (const std::bad_alloc&) {
+		error = "Not enough memory for " + path;
+		return false;
+	}
+}
+
+bool TDataset::Load_CSV(const std::string& path, std::string& error) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open()) {
+		error = "Cannot open " + path;
+		return false;
+	}
+
+	std::vector<std::vector<Vector2>> classes;
+
+	std::string line;
+	while (std::getline(in, line)) {
+		const char* cur = line.data();
+		const char* end = line.data() + line.size();
+
+		Vector2 pt;
+		float cls = 0.0f;
+		if (!Parse_Float(cur, end, pt.x) || cur >= end || *cur++ != ',' || !Parse_Float(cur, end, pt.y)) {
+			continue;
+		}
+		if (cur < end && *cur == ',') {
+			cur++;
+			if (!Parse_Float(cur, end, cls) || cls < 0.0f || cls > static_cast<float>(Max_CSV_Class)) {
+				continue;
+			}
+		}
+
+		const size_t classIdx = static_cast<size_t>(cls);
+		if (classIdx >= classes.size()) {
+			classes.resize(classIdx + 1);
+		}
+		classes[classIdx].push_back(pt);
+	}
+
+	if (classes.empty()) {
+		error = "No points found in " + path;
+		return false;
+	}
+
+	// store the classes one after another, so all points are contiguous as in the binary format
+	auto storage = std::make_shared<std::vector<Vector2>>();
+	for (const auto& cls : classes) {
+		storage->insert(storage->end(), cls.begin(), cls.end());
+	}
+
+	mClasses.clear();
+	size_t offset = 0;
+	for (const auto& cls : classes) {
+		mClasses.emplace_back(storage->data() + offset, cls.size());
+		offset += cls.size();
+	}
+	mAll_Points = { storage->data(), storage->size() };
+	mStorage = storage;
+
+	return true;
+}
+
+bool TDataset::Load_Binary(const std::string& path, std::string& error) {
+	auto file = std::make_shared<TMapped_File>(path);
+	if (!file->Is_Open()) {
+		error = "Cannot map " + path;
+		return false;
+	}
+
+	TBinary_Header header;
+	if (file->Size() < sizeof(header)) {
+		error = "File too short";
+		return false;
+	}
+	std::memcpy(&header, file->Data(), sizeof(header));
+
+	if (std::memcmp(header.magic, Binary_Magic, sizeof(Binary_Magic)) != 0 || header.version != Binary_Version) {
+		error = "Not a dataset file (or unsupported version)";
+		return false;
+	}
+
+	// validated before any size arithmetic, size_t is 32-bit in the web build
+	const uint64_t maxClassCount = static_cast<uint64_t>(file->Size() - sizeof(header)) / sizeof(uint64_t);
+	if (header.classCount == 0 || header.classCount > maxClassCount) {
+		error = "Invalid class count";
+		return false;
+	}
+	const size_t countsOffset = sizeof(header);
+	const size_t pointsOffset = countsOffset + static_cast<size_t>(header.classCount) * sizeof(uint64_t);
+
+	std::vector<uint64_t> counts(header.classCount);
+	std::memcpy(counts.data(), file->Data() + countsOffset, counts.size() * sizeof(uint64_t));
+
+	const uint64_t maxPoints = (file->Size() - pointsOffset) / sizeof(Vector2);
+	uint64_t total = 0;
+	for (auto count : counts) {
+		if (count > maxPoints - total) {
+			error = "Truncated dataset file";
+			return false;
+		}
+		total += count;
+	}
+
+	// header and counts are multiples of 8 bytes, so the points are properly aligned in the mapping
+	const Vector2* points = reinterpret_cast<const Vector2*>(file->Data() + pointsOffset);
+
+	mClasses.clear();
+	uint64_t offset = 0;
+	for (auto count : counts) {
+		mClasses.emplace_back(points + offset, static_cast<size_t>(count));
+		offset += count;
+	}
+	mAll_Points = { points, static_cast<size_t>(total) };
+	mStorage = file;
+
+	return true;
+}
@@ -0,0 +1,112 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+#include "raylib.h"
+
+/**
+ * Set of 2D points; it either owns its points (e.g., clicked by the user), or views an external
+ * storage (e.g., a memory-mapped dataset file) without copying; the view is copied on first modification
+ */
+class TPoint_Set {
+	private:
+		std::vector<Vector2> mOwned;
+
+		// keeps the viewed storage alive
+		std::shared_ptr<const void> mStorage;
+
+		const Vector2* mData = nullptr;
+		size_t mSize = 0;
+
+		// incremented on every modification (so the dependent caches know when to refresh); read by the optimizer thread
+		std::atomic<uint64_t> mRevision{ 0 };
+		// incremented when the points are replaced or removed (i.e., on modifications other than appending)
+		uint64_t mReset_Revision = 0;
+
+		void Make_Owned();
+
+	public:
+		TPoint_Set() = default;
+
+		TPoint_Set(const TPoint_Set& other);
+		TPoint_Set& operator=(const TPoint_Set& other);
+
+		// view external storage; storage keeps the data alive
+		void Assign_View(std::shared_ptr<const void> storage, std::span<const Vector2> points);
+
+		void push_back(const Vector2& point);
+		void clear();
+
+		size_t size() const { return mSize; }
+		bool empty() const { return mSize == 0; }
+
+		const Vector2* data() const { return mData; }
+		const Vector2* begin() const { return mData; }
+		const Vector2* end() const { return mData + mSize; }
+
+		const Vector2& operator[](size_t index) const { return mData[index]; }
+
+		std::span<const Vector2> Points() const { return { mData, mSize }; }
+
+		uint64_t Revision() const { return mRevision; }
+		uint64_t Reset_Revision() const { return mReset_Revision; }
+};
+
+/**
+ * Point dataset loaded from a file; points are grouped by class
+ *
+ * Supported formats:
+ *  - CSV (.csv): lines of "x,y" or "x,y,class"; non-numeric lines (e.g., header) are skipped; loaded to memory
+ *  - binary (.ovdp): memory-mapped and read zero-copy; layout (little endian):
+ *       char magic[4] = "OVDP", uint32 version = 1, uint32 classCount, uint32 reserved,
+ *       uint64 pointCount[classCount],
+ *       float32 x, y pairs of class 0, then of class 1, ...
+ */
+class TDataset {
+	private:
+		std::shared_ptr<const void> mStorage;
+		std::vector<std::span<const Vector2>> mClasses;
+		std::span<const Vector2> mAll_Points;
+
+		bool Load_CSV(const std::string& path, std::string& error);
+		bool Load_Binary(const std::string& path, std::string& error);
+
+	public:
+		// load dataset (format determined by extension), returns false and fills error on failure
+		bool Load(const std::string& path, std::string& error);
+
+		size_t Class_Count() const {
+			return mClasses.size();
+		}
+
+		// points of all classes (contiguous)
+		std::span<const Vector2> All_Points() const {
+			return mAll_Points;
+		}
+
+		std::span<const Vector2> Class_Points(size_t classIdx) const {
+			return classIdx < mClasses.size() ? mClasses[classIdx] : std::span<const Vector2>{};
+		}
+
+		// fill the point set with a zero-copy view of all points
+		void View_All(TPoint_Set& target) const {
+			target.Assign_View(mStorage, mAll_Points);
+		}
+
+		// fill the point set with a zero-copy view of a single class
+		void View_Class(size_t classIdx, TPoint_Set& target) const {
+			target.Assign_View(mStorage, Class_Points(classIdx));
+		}
+};
@@ -8,36 +8,142 @@
 #include "DrawProxy.h"
 
 #include "raylib.h"
+#include "rlgl.h"
 
-std::map<NAppFont, TFont_Ptr> DrawProxy::mFonts;
+#include <algorithm>
+
+std::array<TFont_Ptr, static_cast<size_t>(NAppFont::count)> DrawProxy::mFonts;
+std::unordered_map<DrawProxy::TText_Key, DrawProxy::TText_Layout, DrawProxy::TText_Key_Hash, DrawProxy::TText_Key_Equal> DrawProxy::mLayout_Cache;
+
+namespace {
+	// raylib default spacing between lines
+	constexpr float Text_Line_Spacing = 2.0f;
+}
+
+void TLine_Batch::Add_Strip(std::span<const Vector2> points, Color color) {
+	for (size_t i = 1; i < points.size(); i++) {
+		mSegments.push_back({ points[i - 1], points[i], color });
+	}
+}
+
+void TLine_Batch::Flush() {
+	if (mSegments.empty()) {
+		return;
+	}
+
+	// one begin/end pair for all the segments; rlgl splits the batch on its own when its vertex buffer fills up
+	rlBegin(RL_LINES);
+	for (const auto& segment : mSegments) {
+		rlColor4ub(segment.color.r, segment.color.g, segment.color.b, segment.color.a);
+		rlVertex2f(segment.from.x, segment.from.y);
+		rlVertex2f(segment.to.x, segment.to.y);
+	}
+	rlEnd();
+
+	mSegments.clear();
+}
+
+TText_Buffer& TText_Buffer::operator<<(std::string_view text) {
+	const size_t count = std::min(text.size(), Capacity - 1 - mLength);
+	text.copy(mData.data() + mLength, count);
+	mLength += count;
+	mData[mLength] = '\0';
+	return *this;
+}
+
+TText_Buffer& TText_Buffer::Append(double value, int precision) {
+	auto [ptr, ec] = std::to_chars(mData.data() + mLength, mData.data() + Capacity - 1, value, std::chars_format::fixed, precision);
+	if (ec == std::errc()) {
+		mLength = ptr - mData.data();
+	}
+	mData[mLength] = '\0';
+	return *this;
+}
 
 void DrawProxy::InitFontsIfNeeded() {
-	if (mFonts.empty()) {
-		mFonts[NAppFont::Title] = std::make_shared<TFont>("assets/OpenSans.ttf", 32);
-		mFonts[NAppFont::Subtitle] = std::make_shared<TFont>("assets/OpenSans.ttf", 24);
-		mFonts[NAppFont::RegularText] = std::make_shared<TFont>("assets/OpenSans.ttf", 16);
+	if (!mFonts[0]) {
+		mFonts[static_cast<size_t>(NAppFont::Title)] = std::make_shared<TFont>("assets/OpenSans.ttf", 32);
+		mFonts[static_cast<size_t>(NAppFont::Subtitle)] = std::make_shared<TFont>("assets/OpenSans.ttf", 24);
+		mFonts[static_cast<size_t>(NAppFont::RegularText)] = std::make_shared<TFont>("assets/OpenSans.ttf", 16);
 	}
 }
 
-void DrawProxy::Text(const std::string& text, int x, int y, Color color, NAppFont appFont, int spacing) {
-	InitFontsIfNeeded();
+const DrawProxy::TText_Layout& DrawProxy::Get_Layout(std::string_view text, NAppFont appFont, int spacing) {
+	auto it = mLayout_Cache.find(TText_Key_View{ text, appFont, spacing });
+	if (it != mLayout_Cache.end()) {
+		return it->second;
+	}
+
+	if (mLayout_Cache.size() >= Max_Cached_Layouts) {
+		mLayout_Cache.clear();
+	}
+
+	TText_Key key{ std::string(text), appFont, spacing };
+	TText_Layout layout;
+
+	// same glyph placement as DrawTextEx, with the codepoint decoding and glyph lookup done only once
+	const Font& font = mFonts[static_cast<size_t>(appFont)]->Get();
+	const float fontSize = static_cast<float>(font.baseSize);
+	const float padding = static_cast<float>(font.glyphPadding);
+
+	float offsetX = 0.0f;
+	float offsetY = 0.0f;
+	for (size_t i = 0; i < key.text.size();) {
+		int byteCount = 0;
+		const int codepoint = GetCodepointNext(key.text.c_str() + i, &byteCount);
+		const int index = GetGlyphIndex(font, codepoint);
+
+		if (codepoint == '\n') {
+			offsetY += fontSize + Text_Line_Spacing;
+			offsetX = 0.0f;
+		}
+		else {
+			const Rectangle& rec = font.recs[index];
+			const GlyphInfo& glyph = font.glyphs[index];
 
-	auto it = mFonts.find(appFont);
-	if (it != mFonts.end()) {
-		DrawTextEx(*(it->second), text.c_str(), { (float)x, (float)y }, (float)it->second->GetBaseSize(), (float)spacing, color);
+			if (codepoint != ' ' && codepoint != '\t') {
+				layout.glyphs.push_back({
+					{ rec.x - padding, rec.y - padding, rec.width + 2.0f * padding, rec.height + 2.0f * padding },
+					{ offsetX + glyph.offsetX - padding, offsetY + glyph.offsetY - padding, rec.width + 2.0f * padding, rec.height + 2.0f * padding }
+				});
+			}
+
+			offsetX += ((glyph.advanceX == 0) ? rec.width : static_cast<float>(glyph.advanceX)) + static_cast<float>(spacing);
+		}
+
+		i += std::max(byteCount, 1);
 	}
+
+	const Vector2 size = MeasureTextEx(font, key.text.c_str(), fontSize, static_cast<float>(spacing));
+	layout.width = static_cast<int>(size.x);
+	layout.height = static_cast<int>(size.y);
+
+	return mLayout_Cache.emplace(std::move(key), std::move(layout)).first->second;
 }
 
-void DrawProxy::MeasureText(const std::string& text, int& width, int& height, NAppFont appFont, int spacing) {
+void DrawProxy::Text(std::string_view text, int x, int y, Color color, NAppFont appFont, int spacing) {
 	InitFontsIfNeeded();
-	auto it = mFonts.find(appFont);
-	if (it != mFonts.end()) {
-		Vector2 size = MeasureTextEx(*(it->second), text.c_str(), (float)it->second->GetBaseSize(), (float)spacing);
-		width = (int)size.x;
-		height = (int)size.y;
-	}
-	else {
-		width = 0;
-		height = 0;
+
+	const auto& layout = Get_Layout(text, appFont, spacing);
+	const Texture2D& texture = mFonts[static_cast<size_t>(appFont)]->Get().texture;
+
+	for (const auto& glyph : layout.glyphs) {
+		const Rectangle dest = { glyph.dest.x + static_cast<float>(x), glyph.dest.y + static_cast<float>(y), glyph.dest.width, glyph.dest.height };
+		DrawTexturePro(texture, glyph.source, dest, { 0.0f, 0.0f }, 0.0f, color);
 	}
 }
+
+void DrawProxy::Text_Uncached(const char* text, int x, int y, Color color, NAppFont appFont, int spacing) {
+	InitFontsIfNeeded();
+
+	const auto& font = mFonts[static_cast<size_t>(appFont)];
+	DrawTextEx(*font, text, { (float)x, (float)y }, (float)font->GetBaseSize(), (float)spacing, color);
+}
+
+void DrawProxy::MeasureText(std::string_view text, int& width, int& height, NAppFont appFont, int spacing) {
+	InitFontsIfNeeded();
+
+	const auto& layout = Get_Layout(text, appFont, spacing);
+	width = layout.width;
+	height = layout.height;
+}
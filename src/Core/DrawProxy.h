@@ -8,15 +8,23 @@
 #pragma once
 
 #include <string>
-#include <map>
+#include <string_view>
+#include <array>
+#include <unordered_map>
 #include <memory>
+#include <vector>
+#include <span>
+#include <charconv>
+#include <concepts>
 #include "raylib.h"
 
  // application fonts
 enum class NAppFont {
 	Title,
 	Subtitle,
-	RegularText
+	RegularText,
+
+	count
 };
 
 /**
@@ -43,6 +51,10 @@ class TFont {
 			return font;
 		}
 
+		const Font& Get() const {
+			return font;
+		}
+
 		int GetBaseSize() const {
 			return font.baseSize;
 		}
@@ -50,16 +62,151 @@ class TFont {
 
 using TFont_Ptr = std::shared_ptr<TFont>;
 
+/**
+ * Batch of thin (1px) line segments, submitted to rlgl at once on Flush instead of a draw call per segment
+ * The storage is reused between frames, so the batch does not allocate once warmed up
+ */
+class TLine_Batch {
+	private:
+		struct TSegment {
+			Vector2 from;
+			Vector2 to;
+			Color color;
+		};
+
+		std::vector<TSegment> mSegments;
+
+	public:
+		void Add(const Vector2& from, const Vector2& to, Color color) {
+			mSegments.push_back({ from, to, color });
+		}
+
+		// adds a polyline connecting the given points
+		void Add_Strip(std::span<const Vector2> points, Color color);
+
+		// submits all segments and clears the batch
+		void Flush();
+};
+
+/**
+ * Fixed-size buffer for formatting volatile text (e.g., numbers in status lines) without allocations
+ * Text exceeding the capacity is truncated
+ */
+class TText_Buffer {
+	private:
+		static constexpr size_t Capacity = 256;
+
+		std::array<char, Capacity> mData{};
+		size_t mLength = 0;
+
+	public:
+		TText_Buffer& operator<<(std::string_view text);
+
+		// fixed notation with 6 decimal places (same as std::to_string)
+		TText_Buffer& operator<<(double value) {
+			return Append(value, 6);
+		}
+
+		template<std::integral T>
+		TText_Buffer& operator<<(T value) {
+			auto [ptr, ec] = std::to_chars(mData.data() + mLength, mData.data() + Capacity - 1, value);
+			if (ec == std::errc()) {
+				mLength = ptr - mData.data();
+			}
+			mData[mLength] = '\0';
+			return *this;
+		}
+
+		// fixed notation with given number of decimal places
+		TText_Buffer& Append(double value, int precision);
+
+		void Clear() {
+			mLength = 0;
+			mData[0] = '\0';
+		}
+
+		const char* c_str() const {
+			return mData.data();
+		}
+
+		std::string_view View() const {
+			return { mData.data(), mLength };
+		}
+};
+
 /**
  * Drawing proxy for text rendering, maintains fonts
+ *
+ * Text drawn by Text and measured by MeasureText is laid out once (glyph lookup and placement) and cached by
+ * (text, font, spacing); volatile text (e.g., changing numbers) should be drawn by Text_Uncached, so it does not flood the cache
  */
 class DrawProxy {
 	public:
-		static void Text(const std::string& text, int x, int y, Color color, NAppFont appFont = NAppFont::RegularText, int spacing = 0);
-		static void MeasureText(const std::string& text, int& width, int& height, NAppFont appFont = NAppFont::RegularText, int spacing = 0);
+		static void Text(std::string_view text, int x, int y, Color color, NAppFont appFont = NAppFont::RegularText, int spacing = 0);
+		static void Text_Uncached(const char* text, int x, int y, Color color, NAppFont appFont = NAppFont::RegularText, int spacing = 0);
+		static void MeasureText(std::string_view text, int& width, int& height, NAppFont appFont = NAppFont::RegularText, int spacing = 0);
 
 	private:
-		static std::map<NAppFont, TFont_Ptr> mFonts;
+		// glyph quad relative to the text origin
+		struct TGlyph_Quad {
+			Rectangle source;
+			Rectangle dest;
+		};
+
+		struct TText_Layout {
+			std::vector<TGlyph_Quad> glyphs;
+			int width = 0;
+			int height = 0;
+		};
+
+		struct TText_Key {
+			std::string text;
+			NAppFont font;
+			int spacing;
+		};
+
+		// non-owning key, so the lookup does not allocate
+		struct TText_Key_View {
+			std::string_view text;
+			NAppFont font;
+			int spacing;
+		};
+
+		struct TText_Key_Hash {
+			using is_transparent = void;
+
+			size_t operator()(const TText_Key_View& key) const {
+				return std::hash<std::string_view>{}(key.text) ^ (static_cast<size_t>(key.font) << 24) ^ (static_cast<size_t>(key.spacing) << 16);
+			}
+			size_t operator()(const TText_Key& key) const {
+				return (*this)(TText_Key_View{ key.text, key.font, key.spacing });
+			}
+		};
+
+		struct TText_Key_Equal {
+			using is_transparent = void;
+
+			static TText_Key_View View(const TText_Key& key) {
+				return { key.text, key.font, key.spacing };
+			}
+			static TText_Key_View View(const TText_Key_View& key) {
+				return key;
+			}
+
+			template<typename TA, typename TB>
+			bool operator()(const TA& a, const TB& b) const {
+				const TText_Key_View va = View(a);
+				const TText_Key_View vb = View(b);
+				return va.font == vb.font && va.spacing == vb.spacing && va.text == vb.text;
+			}
+		};
+
+		// the cache is dropped as a whole when it grows over this limit
+		static constexpr size_t Max_Cached_Layouts = 1024;
+
+		static std::array<TFont_Ptr, static_cast<size_t>(NAppFont::count)> mFonts;
+		static std::unordered_map<TText_Key, TText_Layout, TText_Key_Hash, TText_Key_Equal> mLayout_Cache;
 
 		static void InitFontsIfNeeded();
+		static const TText_Layout& Get_Layout(std::string_view text, NAppFont appFont, int spacing);
 };
@@ -11,9 +11,31 @@
 #include "DrawProxy.h"
 
 #include "Helpers.h"
+#include "PerfCounters.h"
 
 #include "Optimizer.h"
+#include "Checkpoint.h"
+#include "Surrogate.h"
 #include "../Optimizers/GeneticAlgorithm.h"
+#include "../Optimizers/SteadyStateGeneticAlgorithm.h"
+
+#include <random>
+#include <algorithm>
+#include <filesystem>
+
+namespace {
+	// datasets with at least this many points are optimized with mini-batch evaluation
+	constexpr size_t Mini_Batch_Threshold = 20000;
+	constexpr size_t Mini_Batch_Min_Size = 1024;
+	constexpr size_t Mini_Batch_Max_Size = 16384;
+
+	// render budget: the best candidates drawn in full detail, and the maximum number of the other candidates drawn in reduced detail
+	constexpr size_t Render_Full_Detail_Count = 3;
+	constexpr size_t Render_Reduced_Budget = 100;
+
+	// height of the title bar layer (the bar and the description below it)
+	constexpr int Title_Layer_Height = 80;
+}
 
 bool Experiment::Is_Mouse_In_UI_Area() const {
 	auto pos = GetMousePosition();
@@ -23,25 +45,58 @@ bool Experiment::Is_Mouse_In_UI_Area() const {
 		return true;
 	}
 	// buttons on the top right
-	if (pos.x > GetScreenWidth() - 110 && pos.y < 200) {
+	if (pos.x > GetScreenWidth() - 110 && pos.y < 290) {
 		return true;
 	}
 
 	return false;
 }
 
+bool Experiment::Refresh_Render_Candidates() {
+	std::lock_guard<std::mutex> lock(mCandidates_Mutex);
+	if (mRender_Candidates_Revision == mCandidates_Revision) {
+		return false;
+	}
+
+	// element-wise assignment reuses the storage of the previous copy
+	mRender_Candidates = mCandidates;
+	mRender_Candidates_Revision = mCandidates_Revision;
+	return true;
+}
+
+void Experiment::Objective_Function_Batch(std::span<const std::vector<double>> candidates, std::span<double> values) {
+	for (size_t i = 0; i < candidates.size(); i++) {
+		values[i] = Objective_Function(candidates[i]);
+	}
+}
+
+NOptimizer Experiment::Optimizer_Type() const {
+	return NOptimizer::GeneticAlgorithm_Simple;
+}
+
 bool Experiment::On_Render() {
 	// draw candidates
-	{
-		std::lock_guard<std::mutex> lock(mCandidates_Mutex);
-		if (mCandidates.size() > 0) {
-			for (size_t i = 1; i < mCandidates.size(); ++i) {
-				Draw_Candidate(mCandidates[i], false);
-			}
+	Refresh_Render_Candidates();
+	if (mRender_Candidates.size() > 0) {
+		const size_t count = mRender_Candidates.size();
+
+		// the population is sorted by the objective value - decimate the tail to fit the budget
+		const size_t firstReduced = 1 + Render_Full_Detail_Count;
+		const size_t reducedCount = count > firstReduced ? count - firstReduced : 0;
+		const size_t stride = std::max<size_t>(1, (reducedCount + Render_Reduced_Budget - 1) / Render_Reduced_Budget);
+		for (size_t i = firstReduced; i < count; i += stride) {
+			Draw_Candidate(mRender_Candidates[i], false, NDraw_Detail::Reduced);
+		}
+		mLine_Batch.Flush();
 
-			// draw the best candidate on top
-			Draw_Candidate(mCandidates[0], true);
+		for (size_t i = 1; i < std::min(count, firstReduced); ++i) {
+			Draw_Candidate(mRender_Candidates[i], false, NDraw_Detail::Full);
 		}
+		mLine_Batch.Flush();
+
+		// draw the best candidate on top
+		Draw_Candidate(mRender_Candidates[0], true, NDraw_Detail::Full);
+		mLine_Batch.Flush();
 	}
 
 	TSimple_Button btnClear(GetScreenWidth() - 10 - 100, 50, 100, 30, "Clear");
@@ -64,13 +119,45 @@ bool Experiment::On_Render() {
 		Start_Optimization(TExperiment_Optimize_Mode::Slow);
 	}
 
-	if (mIs_Optimizing) {
-		DrawProxy::Text("Optimizing... Iteration: " + std::to_string(mOpt_Iteration) + " Best Metric: " + std::to_string(mOpt_BestMetric), 10, GetScreenHeight() - 30, DARKGRAY, NAppFont::RegularText);
+	TSimple_Button btnOptimizeStepped(GetScreenWidth() - 10 - 100, 210, 100, 30, "Optimize stepped");
+	if (btnOptimizeStepped.Render()) {
+		Start_Optimization(TExperiment_Optimize_Mode::Stepped);
+	}
+
+	Report_Optimization_Failure();
+
+	if (Is_Optimizing()) {
+		const bool paused = mOptimization_Job->Is_Paused();
+
+		TSimple_Button btnPause(GetScreenWidth() - 10 - 100, 250, 100, 30, paused ? (mOpt_Mode == TExperiment_Optimize_Mode::Stepped ? "Next step" : "Resume") : "Pause");
+		if (btnPause.Render()) {
+			if (paused) {
+				mOptimization_Job->Resume();
+			}
+			else {
+				mOptimization_Job->Pause();
+			}
+		}
+
+		const auto progress = mOptimization_Job->Get_Progress();
+
+		TText_Buffer status;
+		status << (paused ? "Paused... Iteration: " : "Optimizing... Iteration: ") << progress.iteration << " Best Metric: " << progress.bestMetric;
+		DrawProxy::Text_Uncached(status.c_str(), 10, GetScreenHeight() - 30, DARKGRAY, NAppFont::RegularText);
 	}
 	else {
+		if (mCheckpoint_Available) {
+			TSimple_Button btnResume(GetScreenWidth() - 10 - 100, 250, 100, 30, "Resume last");
+			if (btnResume.Render()) {
+				Resume_Optimization();
+			}
+		}
+
 		if (!Draw_Cannot_Optimize_Reason(10, GetScreenHeight() - 30)) {
-			if (mCandidates.size() > 0) {
-				DrawProxy::Text("Optimization complete. Best Metric: " + std::to_string(mOpt_BestMetric), 10, GetScreenHeight() - 30, DARKGRAY, NAppFont::RegularText);
+			if (mRender_Candidates.size() > 0) {
+				TText_Buffer status;
+				status << "Optimization complete. Best Metric: " << mOpt_BestMetric;
+				DrawProxy::Text(status.View(), 10, GetScreenHeight() - 30, DARKGRAY, NAppFont::RegularText);
 			}
 			else {
 				DrawProxy::Text("Click 'Optimize' to start", 10, GetScreenHeight() - 30, DARKGRAY, NAppFont::RegularText);
@@ -78,8 +165,29 @@ bool Experiment::On_Render() {
 		}
 	}
 
-	// title bar
-	DrawRectangle(0, 0, GetScreenWidth(), 40, LIGHTGRAY);
+	Handle_Dropped_Files();
+
+	if (!mDataset_Message.empty() && GetTime() - mDataset_Message_Time < 5.0) {
+		DrawProxy::Text(mDataset_Message, 10, GetScreenHeight() - 70, DARKGRAY, NAppFont::RegularText);
+	}
+
+	if (IsKeyPressed(KEY_F3)) {
+		PerfCounters::Set_Enabled(!PerfCounters::Is_Enabled());
+		PerfCounters::Instance().Reset();
+	}
+
+	if (PerfCounters::Is_Enabled()) {
+		Draw_Perf_Overlay();
+	}
+
+	// title bar with the experiment name and description
+	const uint64_t titleRevision = std::hash<std::string>{}(mName) ^ (std::hash<std::string>{}(mDescription) << 1);
+	mTitle_Layer.Update(GetScreenWidth(), Title_Layer_Height, titleRevision, [this]() {
+		DrawRectangle(0, 0, GetScreenWidth(), 40, LIGHTGRAY);
+		DrawProxy::Text(mName, 48, 3, DARKGRAY, NAppFont::Title);
+		DrawProxy::Text(mDescription, 10, 45, DARKGRAY, NAppFont::Subtitle);
+	});
+	mTitle_Layer.Draw();
 
 	// back button
 	TSimple_Button btnBack(0, 0, 40, 40, "<", NAppFont::Title);
@@ -88,91 +196,339 @@ bool Experiment::On_Render() {
 		Application::Instance().Request_Stage_Change(NStage::Menu);
 	}
 
-	// experiment name and description
-	DrawProxy::Text(mName, 48, 3, DARKGRAY, NAppFont::Title);
-	DrawProxy::Text(mDescription, 10, 45, DARKGRAY, NAppFont::Subtitle);
-
 	return true;
 }
 
-void Experiment::Reset_Data() {
-	mIs_Optimizing = false;
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
+void Experiment::Draw_Perf_Overlay() {
+	// refresh the statistics twice a second, so the numbers are readable
+	const double now = GetTime();
+	if (now - mPerf_Snapshot_Time >= 0.5) {
+		mPerf_Snapshot = PerfCounters::Instance().Snapshot();
+		mPerf_Snapshot_Time = now;
 	}
+
+	const int width = 360;
+	const int lineHeight = 20;
+	const int x = GetScreenWidth() - width - 10;
+	const int y = GetScreenHeight() - 40 - 5 * lineHeight - 10;
+
+	DrawRectangle(x, y, width, 5 * lineHeight + 10, Fade(LIGHTGRAY, 0.85f));
+
+	const auto& eval = mPerf_Snapshot[NPerf_Counter::Evaluation];
+	const auto& gen = mPerf_Snapshot[NPerf_Counter::Generation];
+	const auto& cb = mPerf_Snapshot[NPerf_Counter::Callback];
+	const auto& frame = mPerf_Snapshot[NPerf_Counter::Frame];
+
+	TText_Buffer line;
+	line << "Evaluations/s: " << static_cast<long long>(eval.ratePerSec);
+	DrawProxy::Text_Uncached(line.c_str(), x + 5, y + 5, DARKGRAY, NAppFont::RegularText);
+
+	line.Clear();
+	line << "Evaluation: mean " << eval.meanUs << " us, p99 " << eval.p99Us << " us";
+	DrawProxy::Text_Uncached(line.c_str(), x + 5, y + 5 + lineHeight, DARKGRAY, NAppFont::RegularText);
+
+	line.Clear();
+	line << "Generation: mean " << gen.meanUs << " us (" << static_cast<long long>(gen.ratePerSec) << "/s)";
+	DrawProxy::Text_Uncached(line.c_str(), x + 5, y + 5 + 2 * lineHeight, DARKGRAY, NAppFont::RegularText);
+
+	line.Clear();
+	line << "Callback: mean " << cb.meanUs << " us (" << static_cast<long long>(cb.ratePerSec) << "/s)";
+	DrawProxy::Text_Uncached(line.c_str(), x + 5, y + 5 + 3 * lineHeight, DARKGRAY, NAppFont::RegularText);
+
+	line.Clear();
+	line << "Frame: mean " << frame.meanUs << " us, p99 " << frame.p99Us << " us";
+	DrawProxy::Text_Uncached(line.c_str(), x + 5, y + 5 + 4 * lineHeight, DARKGRAY, NAppFont::RegularText);
+}
+
+void Experiment::Handle_Dropped_Files() {
+	if (!IsFileDropped()) {
+		return;
+	}
+
+	FilePathList files = LoadDroppedFiles();
+	if (files.count > 0) {
+		const std::string path = files.paths[0];
+
+		mDataset_Message_Time = GetTime();
+
+		if (Is_Optimizing()) {
+			mDataset_Message = "Cannot load a dataset while optimizing";
+		}
+		else {
+			TDataset dataset;
+			std::string error;
+			if (!dataset.Load(path, error)) {
+				mDataset_Message = "Dataset load failed: " + error;
+			}
+			else if (!Load_Dataset(dataset)) {
+				mDataset_Message = "This experiment does not support datasets";
+			}
+			else {
+				mCandidates.clear();
+				mCandidates_Revision++;
+				mOpt_Iteration = 0;
+				mOpt_BestMetric = std::numeric_limits<double>::infinity();
+				mDataset_Message = "Loaded " + std::to_string(dataset.All_Points().size()) + " points from " + GetFileName(path.c_str());
+			}
+		}
+	}
+
+	UnloadDroppedFiles(files);
+}
+
+void Experiment::Select_Data_Subset(size_t subsetSize, uint64_t seed) {
+	const size_t count = Data_Point_Count();
+	if (subsetSize == 0 || subsetSize >= count) {
+		mSubset_Indices.clear();
+		return;
+	}
+
+	std::mt19937_64 gen(seed);
+	std::uniform_int_distribution<uint32_t> dis(0, static_cast<uint32_t>(count - 1));
+
+	mSubset_Indices.resize(subsetSize);
+	for (auto& idx : mSubset_Indices) {
+		idx = dis(gen);
+	}
+}
+
+void Experiment::Reset_Data() {
+	Stop_Optimization();
 	mCandidates.clear();
+	mCandidates_Revision++;
 	mOpt_Iteration = 0;
 	mOpt_BestMetric = std::numeric_limits<double>::infinity();
 }
 
-void Experiment::Start_Optimization(TExperiment_Optimize_Mode mode) {
-	if (mIs_Optimizing) {
+bool Experiment::Is_Optimizing() const {
+	return mOptimization_Job && !mOptimization_Job->Is_Done();
+}
+
+void Experiment::Report_Optimization_Failure() {
+	if (!mOptimization_Job || !mOptimization_Job->Is_Done()) {
 		return;
 	}
 
-	if (!Check_Can_Optimize()) {
+	const auto& result = mOptimization_Job->Get_Future();
+	if (result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		return;
+	}
+
+	try {
+		result.get();
+	}
+	catch (const std::exception& e) {
+		mDataset_Message = std::string("Optimization failed: ") + e.what();
+		mDataset_Message_Time = GetTime();
+		mOptimization_Job.reset();
+	}
+}
+
+void Experiment::Stop_Optimization() {
+	if (mOptimization_Job) {
+		mOptimization_Job->Cancel();
+		mOptimization_Job->Wait();
+		mOptimization_Job.reset();
+	}
+}
+
+void Experiment::Set_Checkpoint_Path(const std::string& path) {
+	mCheckpoint_Path = path;
+
+	std::error_code ec;
+	mCheckpoint_Available = !path.empty() && std::filesystem::exists(path, ec);
+}
+
+void Experiment::Save_Points(TBinary_Writer& writer, const TPoint_Set& points) {
+	writer.Write_Span(points.Points());
+}
+
+bool Experiment::Load_Points(TBinary_Reader& reader, TPoint_Set& points) {
+	auto storage = std::make_shared<std::vector<Vector2>>();
+	if (!reader.Read_Vector(*storage)) {
+		return false;
+	}
+	points.Assign_View(storage, *storage);
+	return true;
+}
+
+void Experiment::Resume_Optimization() {
+	if (Is_Optimizing() || mCheckpoint_Path.empty()) {
+		return;
+	}
+
+	mDataset_Message_Time = GetTime();
+
+	TCheckpoint checkpoint;
+	std::string error;
+	if (!checkpoint.Load(mCheckpoint_Path, error)) {
+		mDataset_Message = "Cannot resume: " + error;
 		return;
 	}
 
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
+	Reset_Data();
+
+	TBinary_Reader reader(checkpoint.experimentData);
+	if (!Load_Checkpoint_Data(reader) || !reader.At_End()) {
+		mDataset_Message = "Cannot resume: invalid experiment data in the checkpoint";
+		return;
 	}
 
-	mIs_Optimizing = true;
-	mOptimization_Thread = std::make_unique<std::thread>([this, mode]() {
+	mDataset_Message = "Resuming from " + mCheckpoint_Path;
+	Start_Optimization(TExperiment_Optimize_Mode::Fast, std::move(checkpoint.optimizerState));
+}
+
+void Experiment::Start_Optimization(TExperiment_Optimize_Mode mode, std::vector<uint8_t> resumeState) {
+	if (Is_Optimizing()) {
+		return;
+	}
+
+	if (!Check_Can_Optimize()) {
+		return;
+	}
+
+	// the data are stored once per run on the UI thread, so the checkpoints do not race with the data edits
+	TBinary_Writer dataWriter;
+	Save_Checkpoint_Data(dataWriter);
+	auto experimentData = std::make_shared<const std::vector<uint8_t>>(dataWriter.Take());
+
+	mOpt_Mode = mode;
+	mOptimization_Job = Application::Instance().Get_Optimization_Worker().Submit([this, mode, experimentData, resumeState = std::move(resumeState)](TOptimization_Job& job) {
 		// Prepare optimizer
 		TOptimizer_Setup setup;
 
+		setup.stopToken = job.Get_Stop_Token();
+
+		setup.resumeState = resumeState;
+		if (!mCheckpoint_Path.empty()) {
+			setup.checkpointFunction = [this, experimentData](std::vector<uint8_t>&& state) {
+				CheckpointWriter::Instance().Submit(mCheckpoint_Path, TCheckpoint::Serialize(*experimentData, state));
+				mCheckpoint_Available = true;
+			};
+		}
+
 		setup.objectiveFunction = [this](const std::vector<double>& params) {
+			TPerf_Scope evaluationScope(NPerf_Counter::Evaluation);
 			return this->Objective_Function(params);
 		};
 
-		setup.callbackFunction = [this, mode](NCallback_Stage stage, size_t iteration, double bestMetric, const std::vector<std::vector<double>>& population) {
+		if (Has_Batch_Objective()) {
+			setup.batchObjectiveFunction = [this](std::span<const std::vector<double>> candidates, std::span<double> values) {
+				// recorded per candidate, so the statistics are comparable with the single candidate evaluation
+				TPerf_Scope evaluationScope(NPerf_Counter::Evaluation, candidates.size());
+				this->Objective_Function_Batch(candidates, values);
+			};
+		}
+
+		if (Has_Coarse_Objective()) {
+			setup.coarseObjectiveFunction = [this](const std::vector<double>& params) {
+				TPerf_Scope evaluationScope(NPerf_Counter::Evaluation);
+				return this->Objective_Function_Coarse(params);
+			};
+		}
+
+		setup.dataRevisionFunction = [this]() {
+			return this->Data_Revision();
+		};
+
+		setup.callbackFunction = [this, mode, &job](NCallback_Stage stage, size_t iteration, double bestMetric, const std::vector<std::vector<double>>& population) {
 			// can be used to visualize the optimization process
 			{
 				std::lock_guard<std::mutex> lock(mCandidates_Mutex);
 				mCandidates = population;
+				mCandidates_Revision++;
 				mOpt_Iteration = iteration;
 				mOpt_BestMetric = bestMetric;
 			}
+			job.Report_Progress(iteration, bestMetric);
+
 			// sleep a bit to allow visualization
 			if (mode == TExperiment_Optimize_Mode::Stepped) {
 				// in stepped mode, wait until the user clicks to proceed
-				/*while (mIs_Optimizing) {
-					if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-						break;
-					}
-					std::this_thread::sleep_for(std::chrono::milliseconds(10));
-				}*/
+				job.Pause();
 			}
 			else if (mode == TExperiment_Optimize_Mode::Slow) {
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				job.Sleep_For(std::chrono::milliseconds(100));
 			}
 			else if (mode == TExperiment_Optimize_Mode::Medium) {
-				std::this_thread::sleep_for(std::chrono::milliseconds(30));
+				job.Sleep_For(std::chrono::milliseconds(30));
 			}
 
 			Cache_Best_Candidate(bestMetric, population);
 
-			if (!mIs_Optimizing) {
+			if (!job.Wait_If_Paused()) {
 				return NAction::Abort;
 			}
 
 			return NAction::Continue;
 		};
 
-		Fill_Optimizer_Setup(setup);
+		// objective functions only read the experiment data, experiments may opt out in Fill_Optimizer_Setup
+		setup.parallelEvaluation = true;
+
+		// finish early once the search has not improved for a while, instead of spinning until maxIterations
+		setup.stagnationAction = NStagnation_Action::Stop;
+		setup.stagnationPatience = 2000;
 
-		std::vector<double> bestParameters;
-		double bestMetric = 0;
+		// fast mode does not wait for visualization, so there is no point in delivering more than one callback per frame
+		if (mode == TExperiment_Optimize_Mode::Fast) {
+			setup.callbackPolicy = NCallback_Policy::Interval;
+			setup.callbackMinInterval = std::chrono::milliseconds(16);
+		}
+
+		Fill_Optimizer_Setup(setup);
 
-		// TODO: differentiate between different optimizers
-		GeneticAlgorithm ga(0.05, 0.85);
-		ga.Optimize(setup, bestParameters, bestMetric);
+		// only the promising candidates get the true (expensive) evaluation; the batch objective would bypass the screening
+		// with multi-fidelity evaluation, the surrogate screens before the coarse objective (the cheapest filter goes first)
+		TSurrogate_Setup surrogateSetup;
+		Fill_Surrogate_Setup(surrogateSetup);
+		if (surrogateSetup.enabled) {
+			auto& screened = setup.coarseObjectiveFunction ? setup.coarseObjectiveFunction : setup.objectiveFunction;
+			screened = TSurrogate_Objective::Wrap(std::move(screened), setup, surrogateSetup);
+			setup.batchObjectiveFunction = nullptr;
+		}
 
-		mCandidates[0] = bestParameters;
-		mOpt_BestMetric = bestMetric;
+		// large datasets are evaluated on growing random subsets, unless the experiment configured it on its own
+		if (!setup.subsetFunction && Data_Point_Count() >= Mini_Batch_Threshold) {
+			setup.subsetFunction = [this](size_t subsetSize, uint64_t seed) {
+				Select_Data_Subset(subsetSize, seed);
+			};
+			setup.miniBatchMinSize = Mini_Batch_Min_Size;
+			setup.miniBatchMaxSize = Mini_Batch_Max_Size;
+		}
+		mSubset_Indices.clear();
+
+		TOptimization_Result result;
+
+		std::unique_ptr<Optimizer> optimizer;
+		switch (Optimizer_Type()) {
+			case NOptimizer::GeneticAlgorithm_SteadyState:
+				optimizer = std::make_unique<SteadyStateGeneticAlgorithm>(0.05, 0.85);
+				break;
+			default:
+				// the specialized optimizer evaluates the full objective directly, which would bypass the other evaluation modes
+				if (!setup.batchObjectiveFunction && !setup.coarseObjectiveFunction && !setup.subsetFunction && !surrogateSetup.enabled) {
+					optimizer = Create_Fixed_Optimizer(0.05, 0.85);
+				}
+				if (!optimizer) {
+					optimizer = std::make_unique<GeneticAlgorithm>(0.05, 0.85);
+				}
+				break;
+		}
+		optimizer->Optimize(setup, result.bestParameters, result.bestMetric);
+
+		{
+			std::lock_guard<std::mutex> lock(mCandidates_Mutex);
+			if (!result.bestParameters.empty()) {
+				if (mCandidates.empty()) {
+					mCandidates.resize(1);
+				}
+				mCandidates[0] = result.bestParameters;
+				mCandidates_Revision++;
+			}
+			mOpt_BestMetric = result.bestMetric;
+		}
 
-		mIs_Optimizing = false;
+		return result;
 	});
 }
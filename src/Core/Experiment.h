@@ -12,12 +12,23 @@
 #include <thread>
 #include <memory>
 #include <mutex>
+#include <atomic>
 
 #include "Optimizer.h"
+#include "OptimizationWorker.h"
+#include "PerfCounters.h"
+#include "Dataset.h"
+#include "DrawProxy.h"
+#include "RenderLayer.h"
+#include "PointCloud.h"
 
 #include "../registration.h"
 
 struct TOptimizer_Setup;
+struct TSurrogate_Setup;
+class Optimizer;
+// defined in registration.h, which may be the one including this header
+enum class NOptimizer;
 
 enum class TExperiment_Optimize_Mode {
 	Fast,
@@ -26,6 +37,12 @@ enum class TExperiment_Optimize_Mode {
 	Stepped
 };
 
+// level of detail a candidate is drawn with
+enum class NDraw_Detail {
+	Full,		// the best few candidates
+	Reduced		// the rest of the drawn population; coarse geometry, thin lines go to the line batch
+};
+
 /**
  * Base class for experiments
  */
@@ -40,23 +57,113 @@ class Experiment {
 		bool Is_Mouse_In_UI_Area() const;
 
 	protected:
-		bool mIs_Optimizing = false;
-		std::unique_ptr<std::thread> mOptimization_Thread;
+		// currently submitted optimization job (may be already done)
+		TOptimization_Job_Ptr mOptimization_Job;
+		// mode of the last started optimization
+		TExperiment_Optimize_Mode mOpt_Mode = TExperiment_Optimize_Mode::Fast;
 
 		std::mutex mCandidates_Mutex;
 		std::vector<std::vector<double>> mCandidates;
+		// incremented on every change of mCandidates (guarded by mCandidates_Mutex)
+		uint64_t mCandidates_Revision = 0;
+
+		// copy of mCandidates owned by the render thread, so drawing does not hold the mutex
+		std::vector<std::vector<double>> mRender_Candidates;
+		uint64_t mRender_Candidates_Revision = 0;
+
+		// copies mCandidates to mRender_Candidates if they changed since the last call; returns true if so
+		bool Refresh_Render_Candidates();
+
+		// thin lines of the candidates drawn in reduced detail; flushed by the base On_Render
+		TLine_Batch mLine_Batch;
+
+		// retained layer for the static experiment data (data points, obstacles, ...), drawn by the derived classes
+		TRender_Layer mData_Layer;
+		// data points rasterized into the data layer
+		TPoint_Cloud mData_Cloud;
+		// retained layer for the title bar (name and description)
+		TRender_Layer mTitle_Layer;
 
 		size_t mOpt_Iteration = 0;
 		double mOpt_BestMetric = std::numeric_limits<double>::infinity();
 
+		// last performance snapshot shown in the overlay (toggled by F3)
+		TPerf_Snapshot mPerf_Snapshot;
+		double mPerf_Snapshot_Time = 0.0;
+
+		void Draw_Perf_Overlay();
+
+		// result of the last dataset import or checkpoint resume (shown for a while)
+		std::string mDataset_Message;
+		double mDataset_Message_Time = 0.0;
+
+		// the optimization job failed (e.g., invalid optimizer state to resume from) - show the reason and release the job
+		void Report_Optimization_Failure();
+
+		// handle files dropped onto the window (dataset import)
+		void Handle_Dropped_Files();
+
+		// indices of data points sampled for mini-batch evaluation; empty = evaluate on all data points
+		std::vector<uint32_t> mSubset_Indices;
+
+		// number of data points the objective function iterates over (enables mini-batch evaluation for large datasets)
+		virtual size_t Data_Point_Count() const { return 0; }
+
+		// select a random subset of data points (with replacement) for mini-batch evaluation; 0 = all data points
+		void Select_Data_Subset(size_t subsetSize, uint64_t seed);
+
+		// number of samples the objective function iterates over with the current subset
+		size_t Sample_Count(size_t totalCount) const {
+			return mSubset_Indices.empty() ? totalCount : mSubset_Indices.size();
+		}
+
+		// call fnc for each point of the current subset (or for all points, if no subset is selected)
+		template<typename TFnc>
+		void For_Each_Sample(std::span<const Vector2> points, TFnc&& fnc) const {
+			if (mSubset_Indices.empty()) {
+				for (const auto& point : points) {
+					fnc(point);
+				}
+			}
+			else {
+				for (const uint32_t idx : mSubset_Indices) {
+					fnc(points[idx]);
+				}
+			}
+		}
+
 		virtual void Cache_Best_Candidate(double bestMetric, const std::vector<std::vector<double>>& population) { }
 
+		// optimizer specialized for the experiment's fixed number of parameters (see FixedGeneticAlgorithm), nullptr = use the generic one
+		virtual std::unique_ptr<Optimizer> Create_Fixed_Optimizer(double mutationRate, double crossoverRate) { return nullptr; }
+
+		// file the optimization checkpoints are written to (empty = no checkpoints)
+		std::string mCheckpoint_Path;
+		// there is a checkpoint to resume from
+		std::atomic<bool> mCheckpoint_Available{ false };
+
+		// store the experiment data needed to resume an optimization (e.g., data points); called on the UI thread
+		virtual void Save_Checkpoint_Data(TBinary_Writer& writer) const { }
+		// restore the data stored by Save_Checkpoint_Data, returns false if the data are invalid
+		virtual bool Load_Checkpoint_Data(TBinary_Reader& reader) { return true; }
+
+		static void Save_Points(TBinary_Writer& writer, const TPoint_Set& points);
+		static bool Load_Points(TBinary_Reader& reader, TPoint_Set& points);
+
 	public:
 		Experiment() = default;
 		virtual ~Experiment() = default;
 
-		// starts the optimization in a separate thread
-		void Start_Optimization(TExperiment_Optimize_Mode mode);
+		// submits the optimization job to the application optimization worker; resumes from the optimizer state, if given
+		void Start_Optimization(TExperiment_Optimize_Mode mode, std::vector<uint8_t> resumeState = {});
+		// restores the experiment data from the checkpoint and continues its optimization
+		void Resume_Optimization();
+		// set the checkpoint file of this experiment
+		void Set_Checkpoint_Path(const std::string& path);
+		// cancels the optimization job (if any) and waits for it to finish
+		void Stop_Optimization();
+		// is there an optimization job queued or running?
+		bool Is_Optimizing() const;
 
 	public:
 		// initialize experiment
@@ -71,15 +178,32 @@ class Experiment {
 		// render the experiment
 		virtual bool On_Render();
 
-		// draw a candidate solution (best=true for the best candidate)
-		virtual void Draw_Candidate(const std::vector<double>& candidate, bool best = false) { };
+		// draw a candidate solution (best=true for the best candidate); reduced detail is requested for the bulk of large populations
+		virtual void Draw_Candidate(const std::vector<double>& candidate, bool best = false, NDraw_Detail detail = NDraw_Detail::Full) { };
 
 		// objective function to minimize
 		virtual double Objective_Function(const std::vector<double>& parameters) { return 0; }
 
+		// batch objective function, values[i] is the objective of candidates[i]; experiments overriding it return true in Has_Batch_Objective
+		virtual void Objective_Function_Batch(std::span<const std::vector<double>> candidates, std::span<double> values);
+		virtual bool Has_Batch_Objective() const { return false; }
+
+		// cheap approximation of the objective function for multi-fidelity evaluation; experiments overriding it return true in Has_Coarse_Objective
+		virtual double Objective_Function_Coarse(const std::vector<double>& parameters) { return Objective_Function(parameters); }
+		virtual bool Has_Coarse_Objective() const { return false; }
+
+		// value that changes whenever the data the objective function evaluates change (e.g., points added during the optimization)
+		virtual uint64_t Data_Revision() const { return 0; }
+
 		// fill the optimizer setup structure with parameters specific to this experiment
 		virtual void Fill_Optimizer_Setup(TOptimizer_Setup& setup) { };
 
+		// enable the surrogate pre-screening of candidates (for experiments with expensive objective functions)
+		virtual void Fill_Surrogate_Setup(TSurrogate_Setup& setup) { };
+
+		// optimizer to use; experiments with widely varying evaluation cost benefit from the steady-state variant
+		virtual NOptimizer Optimizer_Type() const;
+
 		// check whether the experiment is ready to be optimized (e.g., enough data points, etc.)
 		virtual bool Check_Can_Optimize() { return true; };
 
@@ -88,4 +212,7 @@ class Experiment {
 
 		// reset experiment data (e.g., data points)
 		virtual void Reset_Data();
+
+		// load the experiment data from a dataset, return false if the experiment does not support datasets
+		virtual bool Load_Dataset(const TDataset& dataset) { return false; };
 };
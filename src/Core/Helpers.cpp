@@ -86,7 +86,16 @@ bool TSimple_Input::Render() {
 	DrawRectangleRec(mRect, col);
 	int textWidth = 0;
 	int textHeight = 0;
-	DrawProxy::MeasureText(mState.text + "_", textWidth, textHeight, mAppFont);
-	DrawProxy::Text(mState.text + (mState.isActive ? "_" : ""), (int)(mRect.x + 5), (int)(mRect.y + (mRect.height - textHeight) / 2), DARKGRAY, mAppFont);
+	int cursorWidth = 0;
+	int cursorHeight = 0;
+	DrawProxy::MeasureText(mState.text, textWidth, textHeight, mAppFont);
+	// the text may be empty, align by the cursor height
+	DrawProxy::MeasureText("_", cursorWidth, cursorHeight, mAppFont);
+
+	const int textY = (int)(mRect.y + (mRect.height - cursorHeight) / 2);
+	DrawProxy::Text(mState.text, (int)(mRect.x + 5), textY, DARKGRAY, mAppFont);
+	if (mState.isActive) {
+		DrawProxy::Text("_", (int)(mRect.x + 5) + textWidth, textY, DARKGRAY, mAppFont);
+	}
 	return retval;
 }
@@ -11,6 +11,7 @@
 
 #include "raylib.h"
 #include <string>
+#include <string_view>
 #include "DrawProxy.h"
 
 /**
@@ -40,11 +41,11 @@ class TDrawing_Guard {
 };
 
 /**
- * A simple button UI element
+ * A simple button UI element; the text is not copied, it must outlive the button
  */
 class TSimple_Button {
 	public:
-		TSimple_Button(int x, int y, int width, int height, const std::string& text, NAppFont appFont = NAppFont::RegularText)
+		TSimple_Button(int x, int y, int width, int height, std::string_view text, NAppFont appFont = NAppFont::RegularText)
 			: mRect{ static_cast<float>(x), static_cast<float>(y), static_cast<float>(width), static_cast<float>(height) }, mText(text), mAppFont{ appFont } {
 		}
 
@@ -53,7 +54,7 @@ class TSimple_Button {
 
 	private:
 		Rectangle mRect;
-		std::string mText;
+		std::string_view mText;
 		NAppFont mAppFont = NAppFont::RegularText;
 };
 
@@ -68,11 +69,11 @@ struct TSimple_Input_State {
 };
 
 /**
- * A simple input box UI element
+ * A simple input box UI element; the label is not copied, it must outlive the input
  */
 class TSimple_Input {
 	public:
-		TSimple_Input(int x, int y, int width, int height, const std::string& label, TSimple_Input_State& state, NAppFont appFont = NAppFont::RegularText, NInput_Mask inMask = NInput_Mask::None, int maxLength = -1)
+		TSimple_Input(int x, int y, int width, int height, std::string_view label, TSimple_Input_State& state, NAppFont appFont = NAppFont::RegularText, NInput_Mask inMask = NInput_Mask::None, int maxLength = -1)
 			: mRect{ static_cast<float>(x), static_cast<float>(y), static_cast<float>(width), static_cast<float>(height) }, mLabel(label), mState{ state }, mAppFont{ appFont }, mInMask{ inMask }, mMaxLength{ maxLength } {
 		}
 
@@ -80,7 +81,7 @@ class TSimple_Input {
 
 	private:
 		Rectangle mRect;
-		std::string mLabel;
+		std::string_view mLabel;
 
 		NAppFont mAppFont = NAppFont::RegularText;
 		NInput_Mask mInMask = NInput_Mask::None;
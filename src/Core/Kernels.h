@@ -0,0 +1,305 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <span>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "raylib.h"
+
+#if defined(__wasm_simd128__)
+	#include <wasm_simd128.h>
+	#define OPTDEMO_KERNELS_SIMD 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define OPTDEMO_KERNELS_SIMD 1
+#else
+	#define OPTDEMO_KERNELS_SIMD 0
+#endif
+
+/**
+ * Vectorized hot loops of the objective functions over 2D data points
+ *
+ * The SIMD path is selected at compile time: SSE2 on x86 (baseline of x86-64), WebAssembly SIMD when the web build
+ * is compiled with -msimd128 (OPTDEMO_WASM_SIMD), scalar code otherwise. WebAssembly cannot pick the path at run time,
+ * so build_web.sh builds both web variants and misc/index.html loads the one the browser supports. The points are processed in pairs as
+ * doubles, so the results match the scalar code up to the summation order
+ */
+namespace Kernels {
+
+#if OPTDEMO_KERNELS_SIMD
+	namespace Detail {
+	#if defined(__wasm_simd128__)
+		using TF64x2 = v128_t;
+
+		inline TF64x2 Splat(double v) { return wasm_f64x2_splat(v); }
+		inline TF64x2 Load(const double* p) { return wasm_v128_load(p); }
+		inline void Store(double* p, TF64x2 v) { wasm_v128_store(p, v); }
+		inline TF64x2 Add(TF64x2 a, TF64x2 b) { return wasm_f64x2_add(a, b); }
+		inline TF64x2 Sub(TF64x2 a, TF64x2 b) { return wasm_f64x2_sub(a, b); }
+		inline TF64x2 Mul(TF64x2 a, TF64x2 b) { return wasm_f64x2_mul(a, b); }
+		inline TF64x2 Min(TF64x2 a, TF64x2 b) { return wasm_f64x2_pmin(a, b); }
+		inline TF64x2 Sqrt(TF64x2 a) { return wasm_f64x2_sqrt(a); }
+		inline double Horizontal_Sum(TF64x2 a) { return wasm_f64x2_extract_lane(a, 0) + wasm_f64x2_extract_lane(a, 1); }
+
+		// loads two points, returns (x0, x1) and (y0, y1)
+		inline void Load_Points(const Vector2* points, TF64x2& xs, TF64x2& ys) {
+			const v128_t v = wasm_v128_load(points);
+			const v128_t p0 = wasm_f64x2_promote_low_f32x4(v);
+			const v128_t p1 = wasm_f64x2_promote_low_f32x4(wasm_i32x4_shuffle(v, v, 2, 3, 0, 1));
+			xs = wasm_i64x2_shuffle(p0, p1, 0, 2);
+			ys = wasm_i64x2_shuffle(p0, p1, 1, 3);
+		}
+	#else
+		using TF64x2 = __m128d;
+
+		inline TF64x2 Splat(double v) { return _mm_set1_pd(v); }
+		inline TF64x2 Load(const double* p) { return _mm_loadu_pd(p); }
+		inline void Store(double* p, TF64x2 v) { _mm_storeu_pd(p, v); }
+		inline TF64x2 Add(TF64x2 a, TF64x2 b) { return _mm_add_pd(a, b); }
+		inline TF64x2 Sub(TF64x2 a, TF64x2 b) { return _mm_sub_pd(a, b); }
+		inline TF64x2 Mul(TF64x2 a, TF64x2 b) { return _mm_mul_pd(a, b); }
+		inline TF64x2 Min(TF64x2 a, TF64x2 b) { return _mm_min_pd(a, b); }
+		inline TF64x2 Sqrt(TF64x2 a) { return _mm_sqrt_pd(a); }
+		inline double Horizontal_Sum(TF64x2 a) { return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a))); }
+
+		// loads two points, returns (x0, x1) and (y0, y1)
+		inline void Load_Points(const Vector2* points, TF64x2& xs, TF64x2& ys) {
+			const __m128 v = _mm_loadu_ps(&points->x);
+			const __m128d p0 = _mm_cvtps_pd(v);
+			const __m128d p1 = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+			xs = _mm_unpacklo_pd(p0, p1);
+			ys = _mm_unpackhi_pd(p0, p1);
+		}
+	#endif
+	}
+#endif
+
+	namespace Detail {
+		// the batch kernels convert the points to doubles in blocks, the candidate tiles then reuse the block from L1 cache
+		constexpr size_t Point_Block = 256;
+
+		struct TPoint_Block {
+			alignas(16) double xs[Point_Block];
+			alignas(16) double ys[Point_Block];
+			size_t size = 0;
+
+			void Fill(std::span<const Vector2> points) {
+				size = points.size();
+				for (size_t i = 0; i < size; i++) {
+					xs[i] = points[i].x;
+					ys[i] = points[i].y;
+				}
+			}
+		};
+
+#if OPTDEMO_KERNELS_SIMD
+		// 2 * Tile candidates against the point block; each point is broadcast once for the whole tile
+		template<size_t Tile>
+		inline void Line_Tile(const TPoint_Block& block, const double* slopes, const double* intercepts, double* sums) {
+			TF64x2 vSlope[Tile], vIntercept[Tile], vSum[Tile];
+			for (size_t t = 0; t < Tile; t++) {
+				vSlope[t] = Load(slopes + 2 * t);
+				vIntercept[t] = Load(intercepts + 2 * t);
+				vSum[t] = Splat(0.0);
+			}
+			for (size_t i = 0; i < block.size; i++) {
+				const TF64x2 x = Splat(block.xs[i]);
+				const TF64x2 y = Splat(block.ys[i]);
+				for (size_t t = 0; t < Tile; t++) {
+					const TF64x2 err = Sub(y, Add(Mul(vSlope[t], x), vIntercept[t]));
+					vSum[t] = Add(vSum[t], Mul(err, err));
+				}
+			}
+			for (size_t t = 0; t < Tile; t++) {
+				Store(sums + 2 * t, Add(Load(sums + 2 * t), vSum[t]));
+			}
+		}
+
+		template<size_t Tile>
+		inline void Circle_Tile(const TPoint_Block& block, const double* centersX, const double* centersY, const double* radii, double* sums) {
+			TF64x2 vCx[Tile], vCy[Tile], vRadius[Tile], vSum[Tile];
+			for (size_t t = 0; t < Tile; t++) {
+				vCx[t] = Load(centersX + 2 * t);
+				vCy[t] = Load(centersY + 2 * t);
+				vRadius[t] = Load(radii + 2 * t);
+				vSum[t] = Splat(0.0);
+			}
+			for (size_t i = 0; i < block.size; i++) {
+				const TF64x2 x = Splat(block.xs[i]);
+				const TF64x2 y = Splat(block.ys[i]);
+				for (size_t t = 0; t < Tile; t++) {
+					const TF64x2 dx = Sub(x, vCx[t]);
+					const TF64x2 dy = Sub(y, vCy[t]);
+					const TF64x2 err = Sub(Sqrt(Add(Mul(dx, dx), Mul(dy, dy))), vRadius[t]);
+					vSum[t] = Add(vSum[t], Mul(err, err));
+				}
+			}
+			for (size_t t = 0; t < Tile; t++) {
+				Store(sums + 2 * t, Add(Load(sums + 2 * t), vSum[t]));
+			}
+		}
+#endif
+	}
+
+	// sum of (y - (slope * x + intercept))^2
+	inline double Sum_Squared_Line_Residuals(std::span<const Vector2> points, double slope, double intercept) {
+		size_t i = 0;
+		double sum = 0.0;
+
+#if OPTDEMO_KERNELS_SIMD
+		using namespace Detail;
+		const TF64x2 vSlope = Splat(slope);
+		const TF64x2 vIntercept = Splat(intercept);
+		TF64x2 vSum = Splat(0.0);
+		for (; i + 2 <= points.size(); i += 2) {
+			TF64x2 xs, ys;
+			Load_Points(points.data() + i, xs, ys);
+			const TF64x2 err = Sub(ys, Add(Mul(vSlope, xs), vIntercept));
+			vSum = Add(vSum, Mul(err, err));
+		}
+		sum = Horizontal_Sum(vSum);
+#endif
+
+		for (; i < points.size(); i++) {
+			const double err = points[i].y - (slope * points[i].x + intercept);
+			sum += err * err;
+		}
+		return sum;
+	}
+
+	// sum of (distance to center - radius)^2
+	inline double Sum_Squared_Circle_Residuals(std::span<const Vector2> points, double centerX, double centerY, double radius) {
+		size_t i = 0;
+		double sum = 0.0;
+
+#if OPTDEMO_KERNELS_SIMD
+		using namespace Detail;
+		const TF64x2 vCx = Splat(centerX);
+		const TF64x2 vCy = Splat(centerY);
+		const TF64x2 vRadius = Splat(radius);
+		TF64x2 vSum = Splat(0.0);
+		for (; i + 2 <= points.size(); i += 2) {
+			TF64x2 xs, ys;
+			Load_Points(points.data() + i, xs, ys);
+			const TF64x2 dx = Sub(xs, vCx);
+			const TF64x2 dy = Sub(ys, vCy);
+			const TF64x2 err = Sub(Sqrt(Add(Mul(dx, dx), Mul(dy, dy))), vRadius);
+			vSum = Add(vSum, Mul(err, err));
+		}
+		sum = Horizontal_Sum(vSum);
+#endif
+
+		for (; i < points.size(); i++) {
+			const double dx = points[i].x - centerX;
+			const double dy = points[i].y - centerY;
+			const double err = std::sqrt(dx * dx + dy * dy) - radius;
+			sum += err * err;
+		}
+		return sum;
+	}
+
+	// sum of squared distances to the nearest centroid; centroids are (x, y) pairs
+	inline double Sum_Min_Squared_Distances(std::span<const Vector2> points, std::span<const double> centroids) {
+		const size_t centroidCount = centroids.size() / 2;
+
+		size_t i = 0;
+		double sum = 0.0;
+
+#if OPTDEMO_KERNELS_SIMD
+		using namespace Detail;
+		TF64x2 vSum = Splat(0.0);
+		for (; i + 2 <= points.size(); i += 2) {
+			TF64x2 xs, ys;
+			Load_Points(points.data() + i, xs, ys);
+			TF64x2 vMin = Splat(std::numeric_limits<double>::infinity());
+			for (size_t c = 0; c < centroidCount; c++) {
+				const TF64x2 dx = Sub(xs, Splat(centroids[2 * c]));
+				const TF64x2 dy = Sub(ys, Splat(centroids[2 * c + 1]));
+				vMin = Min(vMin, Add(Mul(dx, dx), Mul(dy, dy)));
+			}
+			vSum = Add(vSum, vMin);
+		}
+		sum = Horizontal_Sum(vSum);
+#endif
+
+		for (; i < points.size(); i++) {
+			double minDistSq = std::numeric_limits<double>::infinity();
+			for (size_t c = 0; c < centroidCount; c++) {
+				const double dx = points[i].x - centroids[2 * c];
+				const double dy = points[i].y - centroids[2 * c + 1];
+				minDistSq = std::min(minDistSq, dx * dx + dy * dy);
+			}
+			sum += minDistSq;
+		}
+		return sum;
+	}
+
+	// batch variant of Sum_Squared_Line_Residuals; the candidates are given as columns (slopes[c], intercepts[c]) and
+	// scored in SIMD lanes, so the points are read once for all of them
+	inline void Sum_Squared_Line_Residuals_Batch(std::span<const Vector2> points, std::span<const double> slopes, std::span<const double> intercepts, std::span<double> sums) {
+		const size_t count = slopes.size();
+		std::fill(sums.begin(), sums.end(), 0.0);
+
+		Detail::TPoint_Block block;
+		for (size_t start = 0; start < points.size(); start += Detail::Point_Block) {
+			block.Fill(points.subspan(start, std::min(Detail::Point_Block, points.size() - start)));
+
+			size_t c = 0;
+#if OPTDEMO_KERNELS_SIMD
+			for (; c + 8 <= count; c += 8) {
+				Detail::Line_Tile<4>(block, slopes.data() + c, intercepts.data() + c, sums.data() + c);
+			}
+			for (; c + 2 <= count; c += 2) {
+				Detail::Line_Tile<1>(block, slopes.data() + c, intercepts.data() + c, sums.data() + c);
+			}
+#endif
+			for (; c < count; c++) {
+				double sum = 0.0;
+				for (size_t i = 0; i < block.size; i++) {
+					const double err = block.ys[i] - (slopes[c] * block.xs[i] + intercepts[c]);
+					sum += err * err;
+				}
+				sums[c] += sum;
+			}
+		}
+	}
+
+	// batch variant of Sum_Squared_Circle_Residuals; the candidates are given as columns (centersX[c], centersY[c], radii[c])
+	inline void Sum_Squared_Circle_Residuals_Batch(std::span<const Vector2> points, std::span<const double> centersX, std::span<const double> centersY, std::span<const double> radii, std::span<double> sums) {
+		const size_t count = centersX.size();
+		std::fill(sums.begin(), sums.end(), 0.0);
+
+		Detail::TPoint_Block block;
+		for (size_t start = 0; start < points.size(); start += Detail::Point_Block) {
+			block.Fill(points.subspan(start, std::min(Detail::Point_Block, points.size() - start)));
+
+			size_t c = 0;
+#if OPTDEMO_KERNELS_SIMD
+			for (; c + 4 <= count; c += 4) {
+				Detail::Circle_Tile<2>(block, centersX.data() + c, centersY.data() + c, radii.data() + c, sums.data() + c);
+			}
+			for (; c + 2 <= count; c += 2) {
+				Detail::Circle_Tile<1>(block, centersX.data() + c, centersY.data() + c, radii.data() + c, sums.data() + c);
+			}
+#endif
+			for (; c < count; c++) {
+				double sum = 0.0;
+				for (size_t i = 0; i < block.size; i++) {
+					const double dx = block.xs[i] - centersX[c];
+					const double dy = block.ys[i] - centersY[c];
+					const double err = std::sqrt(dx * dx + dy * dy) - radii[c];
+					sum += err * err;
+				}
+				sums[c] += sum;
+			}
+		}
+	}
+}
@@ -0,0 +1,103 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+TMapped_File::TMapped_File(const std::string& path) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	mFile_Handle = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		Close();
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		Close();
+		return;
+	}
+	mMapping_Handle = mapping;
+
+	mData = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!mData) {
+		Close();
+		return;
+	}
+	mSize = static_cast<size_t>(size.QuadPart);
+#else
+	mFd = open(path.c_str(), O_RDONLY);
+	if (mFd < 0) {
+		return;
+	}
+
+	struct stat st;
+	if (fstat(mFd, &st) != 0 || st.st_size <= 0) {
+		Close();
+		return;
+	}
+
+	void* ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, mFd, 0);
+	if (ptr == MAP_FAILED) {
+		Close();
+		return;
+	}
+
+	mData = static_cast<const uint8_t*>(ptr);
+	mSize = static_cast<size_t>(st.st_size);
+
+	// the data are scanned linearly by objective functions
+	madvise(ptr, mSize, MADV_SEQUENTIAL);
+#endif
+}
+
+TMapped_File::~TMapped_File() {
+	Close();
+}
+
+void TMapped_File::Close() {
+#ifdef _WIN32
+	if (mData) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping_Handle) {
+		CloseHandle(static_cast<HANDLE>(mMapping_Handle));
+	}
+	if (mFile_Handle) {
+		CloseHandle(static_cast<HANDLE>(mFile_Handle));
+	}
+	mMapping_Handle = nullptr;
+	mFile_Handle = nullptr;
+#else
+	if (mData) {
+		munmap(const_cast<uint8_t*>(mData), mSize);
+	}
+	if (mFd >= 0) {
+		close(mFd);
+	}
+	mFd = -1;
+#endif
+
+	mData = nullptr;
+	mSize = 0;
+}
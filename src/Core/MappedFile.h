@@ -0,0 +1,51 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Read-only memory mapping of a whole file (RAII-style)
+ * Kept free of raylib includes, as the platform headers clash with raylib names
+ */
+class TMapped_File {
+	private:
+		const uint8_t* mData = nullptr;
+		size_t mSize = 0;
+
+#ifdef _WIN32
+		void* mFile_Handle = nullptr;
+		void* mMapping_Handle = nullptr;
+#else
+		int mFd = -1;
+#endif
+
+		void Close();
+
+	public:
+		TMapped_File() = default;
+		explicit TMapped_File(const std::string& path);
+		virtual ~TMapped_File();
+
+		TMapped_File(const TMapped_File&) = delete;
+		TMapped_File& operator=(const TMapped_File&) = delete;
+
+		bool Is_Open() const {
+			return mData != nullptr;
+		}
+
+		const uint8_t* Data() const {
+			return mData;
+		}
+
+		size_t Size() const {
+			return mSize;
+		}
+};
@@ -0,0 +1,152 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "OptimizationWorker.h"
+
+TOptimization_Job::TOptimization_Job(TJob_Fnc fnc)
+	: mFunction(std::move(fnc)), mResult(mPromise.get_future().share()) {
+}
+
+void TOptimization_Job::Cancel() {
+	mStop_Source.request_stop();
+	// wake up the job if it's paused
+	std::lock_guard<std::mutex> lock(mPause_Mutex);
+	mPause_Cv.notify_all();
+}
+
+void TOptimization_Job::Pause() {
+	std::lock_guard<std::mutex> lock(mPause_Mutex);
+	mPaused = true;
+}
+
+void TOptimization_Job::Resume() {
+	std::lock_guard<std::mutex> lock(mPause_Mutex);
+	mPaused = false;
+	mPause_Cv.notify_all();
+}
+
+bool TOptimization_Job::Wait_If_Paused() {
+	auto token = mStop_Source.get_token();
+
+	std::unique_lock<std::mutex> lock(mPause_Mutex);
+	if (mPaused) {
+		mState = NJob_State::Paused;
+		mPause_Cv.wait(lock, token, [this]() { return !mPaused; });
+		mState = NJob_State::Running;
+	}
+
+	return !token.stop_requested();
+}
+
+bool TOptimization_Job::Sleep_For(std::chrono::milliseconds duration) {
+	auto token = mStop_Source.get_token();
+
+	std::unique_lock<std::mutex> lock(mPause_Mutex);
+	mPause_Cv.wait_for(lock, token, duration, []() { return false; });
+
+	return !token.stop_requested();
+}
+
+void TOptimization_Job::Report_Progress(size_t iteration, double bestMetric) {
+	mProgress_Iteration.store(iteration, std::memory_order_relaxed);
+	mProgress_BestMetric.store(bestMetric, std::memory_order_relaxed);
+}
+
+TOptimization_Progress TOptimization_Job::Get_Progress() const {
+	return { mProgress_Iteration.load(std::memory_order_relaxed), mProgress_BestMetric.load(std::memory_order_relaxed) };
+}
+
+bool TOptimization_Job::Is_Done() const {
+	const auto state = mState.load();
+	return state == NJob_State::Finished || state == NJob_State::Cancelled;
+}
+
+void TOptimization_Job::Wait() const {
+	mResult.wait();
+}
+
+OptimizationWorker::~OptimizationWorker() {
+	Shutdown();
+}
+
+TOptimization_Job_Ptr OptimizationWorker::Submit(TJob_Fnc fnc) {
+	auto job = std::make_shared<TOptimization_Job>(std::move(fnc));
+
+	std::lock_guard<std::mutex> lock(mQueue_Mutex);
+	if (!mThread.joinable()) {
+		mThread = std::jthread([this](std::stop_token stopToken) { Run(stopToken); });
+	}
+	mQueue.push_back(job);
+	mQueue_Cv.notify_one();
+
+	return job;
+}
+
+void OptimizationWorker::Cancel_All() {
+	std::lock_guard<std::mutex> lock(mQueue_Mutex);
+	for (auto& job : mQueue) {
+		job->Cancel();
+	}
+}
+
+void OptimizationWorker::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(mQueue_Mutex);
+		for (auto& job : mQueue) {
+			job->Cancel();
+		}
+	}
+
+	if (mThread.joinable()) {
+		mThread.request_stop();
+		mThread.join();
+	}
+}
+
+void OptimizationWorker::Run(std::stop_token stopToken) {
+	while (!stopToken.stop_requested()) {
+		TOptimization_Job_Ptr job;
+		{
+			std::unique_lock<std::mutex> lock(mQueue_Mutex);
+			if (!mQueue_Cv.wait(lock, stopToken, [this]() { return !mQueue.empty(); })) {
+				break;
+			}
+			// the job stays in the queue while running, so Cancel_All reaches it too
+			job = mQueue.front();
+		}
+
+		if (job->Get_Stop_Token().stop_requested()) {
+			job->mState = NJob_State::Cancelled;
+			job->mPromise.set_value(TOptimization_Result{ .cancelled = true });
+		}
+		else {
+			job->mState = NJob_State::Running;
+			try {
+				auto result = job->mFunction(*job);
+				result.cancelled = job->Get_Stop_Token().stop_requested();
+				job->mState = result.cancelled ? NJob_State::Cancelled : NJob_State::Finished;
+				job->mPromise.set_value(std::move(result));
+			}
+			catch (...) {
+				job->mState = NJob_State::Cancelled;
+				job->mPromise.set_exception(std::current_exception());
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mQueue_Mutex);
+		mQueue.pop_front();
+	}
+
+	// resolve everything left in the queue, so nobody waits forever
+	std::lock_guard<std::mutex> lock(mQueue_Mutex);
+	for (auto& job : mQueue) {
+		job->mStop_Source.request_stop();
+		job->mState = NJob_State::Cancelled;
+		job->mPromise.set_value(TOptimization_Result{ .cancelled = true });
+	}
+	mQueue.clear();
+}
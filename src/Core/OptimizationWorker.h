@@ -0,0 +1,131 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stop_token>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+// state of an optimization job
+enum class NJob_State {
+	Queued,		// waiting in the worker queue
+	Running,	// being executed
+	Paused,		// being executed, but waiting for resume
+	Finished,	// done (the result is available)
+	Cancelled	// cancelled before or during execution
+};
+
+// final result of an optimization job
+struct TOptimization_Result {
+	std::vector<double> bestParameters;
+	double bestMetric = std::numeric_limits<double>::infinity();
+	bool cancelled = false;
+};
+
+// progress snapshot of a running job
+struct TOptimization_Progress {
+	size_t iteration = 0;
+	double bestMetric = std::numeric_limits<double>::infinity();
+};
+
+class TOptimization_Job;
+
+using TJob_Fnc = std::function<TOptimization_Result(TOptimization_Job& job)>;
+
+/**
+ * Single optimization job; shared between the worker (executing it) and the submitter (controlling it)
+ */
+class TOptimization_Job {
+	private:
+		TJob_Fnc mFunction;
+
+		std::stop_source mStop_Source;
+
+		std::promise<TOptimization_Result> mPromise;
+		std::shared_future<TOptimization_Result> mResult;
+
+		std::mutex mPause_Mutex;
+		std::condition_variable_any mPause_Cv;
+		bool mPaused = false;
+
+		std::atomic<NJob_State> mState{ NJob_State::Queued };
+
+		std::atomic<size_t> mProgress_Iteration{ 0 };
+		std::atomic<double> mProgress_BestMetric{ std::numeric_limits<double>::infinity() };
+
+		friend class OptimizationWorker;
+
+	public:
+		explicit TOptimization_Job(TJob_Fnc fnc);
+
+		// stop token to be passed to the optimizer (cooperative cancellation)
+		std::stop_token Get_Stop_Token() const { return mStop_Source.get_token(); }
+
+		// request cancellation; the job stops at the next cancellation point
+		void Cancel();
+		// request pause; the job pauses at the next call of Wait_If_Paused
+		void Pause();
+		// resume a paused job
+		void Resume();
+
+		// called from within the job; blocks while paused, returns false if the job was cancelled
+		bool Wait_If_Paused();
+		// called from within the job; interruptible sleep, returns false if the job was cancelled
+		bool Sleep_For(std::chrono::milliseconds duration);
+
+		// called from within the job to publish progress
+		void Report_Progress(size_t iteration, double bestMetric);
+		TOptimization_Progress Get_Progress() const;
+
+		NJob_State Get_State() const { return mState.load(); }
+		bool Is_Paused() const { return mState.load() == NJob_State::Paused; }
+		bool Is_Done() const;
+
+		// future of the final result
+		const std::shared_future<TOptimization_Result>& Get_Future() const { return mResult; }
+		// blocks until the job is done (finished or cancelled)
+		void Wait() const;
+};
+
+using TOptimization_Job_Ptr = std::shared_ptr<TOptimization_Job>;
+
+/**
+ * Long-lived worker executing optimization jobs one after another in a single persistent thread
+ */
+class OptimizationWorker {
+	private:
+		std::mutex mQueue_Mutex;
+		std::condition_variable_any mQueue_Cv;
+		std::deque<TOptimization_Job_Ptr> mQueue;
+
+		std::jthread mThread;
+
+		void Run(std::stop_token stopToken);
+
+	public:
+		OptimizationWorker() = default;
+		virtual ~OptimizationWorker();
+
+		// queue a job for execution; the worker thread is started on first use
+		TOptimization_Job_Ptr Submit(TJob_Fnc fnc);
+
+		// cancel all queued and running jobs
+		void Cancel_All();
+
+		// cancel all jobs and stop the worker thread
+		void Shutdown();
+};
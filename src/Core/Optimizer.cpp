@@ -0,0 +1,150 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "Optimizer.h"
+#include "ThreadPool.h"
+
+#include <sstream>
+
+namespace {
+	// the generator state is only accessible through the stream operators; store it as binary words, not as text
+	// (the standard library may append its position in the state to the state words)
+	void Save_Generator(TBinary_Writer& writer, const std::mt19937& generator) {
+		std::stringstream ss;
+		ss << generator;
+
+		std::vector<uint32_t> words;
+		words.reserve(std::mt19937::state_size);
+		uint32_t word;
+		while (ss >> word) {
+			words.push_back(word);
+		}
+		writer.Write_Span<uint32_t>(words);
+	}
+
+	bool Load_Generator(TBinary_Reader& reader, std::mt19937& generator) {
+		std::vector<uint32_t> words;
+		if (!reader.Read_Vector(words) || words.size() < std::mt19937::state_size) {
+			return false;
+		}
+
+		std::stringstream ss;
+		for (const uint32_t word : words) {
+			ss << word << ' ';
+		}
+		ss >> generator;
+		return !ss.fail();
+	}
+}
+
+void Optimizer::Save_Base_State(TBinary_Writer& writer) const {
+	writer.Write<uint64_t>(mPopulation.size());
+	for (const auto& individual : mPopulation) {
+		writer.Write_Span<double>(individual);
+	}
+	writer.Write_Span<double>(mObjectiveValues);
+	writer.Write_Span<uint8_t>(mCoarse_Only);
+
+	Save_Generator(writer, mRandGen);
+}
+
+bool Optimizer::Load_Base_State(TBinary_Reader& reader, size_t paramCount) {
+	uint64_t populationSize = 0;
+	if (!reader.Read(populationSize)) {
+		return false;
+	}
+
+	std::vector<std::vector<double>> population(static_cast<size_t>(populationSize));
+	for (auto& individual : population) {
+		if (!reader.Read_Vector(individual) || individual.size() != paramCount) {
+			return false;
+		}
+	}
+
+	std::vector<double> objectiveValues;
+	if (!reader.Read_Vector(objectiveValues) || objectiveValues.size() != population.size()) {
+		return false;
+	}
+
+	std::vector<uint8_t> coarseOnly;
+	if (!reader.Read_Vector(coarseOnly) || (!coarseOnly.empty() && coarseOnly.size() != population.size())) {
+		return false;
+	}
+
+	if (!Load_Generator(reader, mRandGen)) {
+		return false;
+	}
+
+	mPopulation = std::move(population);
+	mObjectiveValues = std::move(objectiveValues);
+	mCoarse_Only = std::move(coarseOnly);
+	return true;
+}
+
+double Optimizer::Promotion_Threshold(const TOptimizer_Setup& setup, std::vector<double>& values) {
+	if (values.empty()) {
+		return std::numeric_limits<double>::infinity();
+	}
+
+	const size_t count = std::clamp<size_t>(static_cast<size_t>(std::llround(setup.promotionFraction * static_cast<double>(values.size()))), 1, values.size());
+	std::nth_element(values.begin(), values.begin() + (count - 1), values.end());
+	return values[count - 1];
+}
+
+size_t Optimizer::Evaluate_Multi_Fidelity(const TOptimizer_Setup& setup, std::vector<size_t>& indices, std::vector<double>& scratch) {
+	if (indices.empty()) {
+		return 0;
+	}
+
+	auto evaluate = [this, &setup, &indices](const TObjective_Fnc& objective) {
+		auto evaluateRange = [this, &objective, &indices](size_t begin, size_t end) {
+			for (size_t k = begin; k < end; ++k) {
+				mObjectiveValues[indices[k]] = objective(mPopulation[indices[k]]);
+			}
+		};
+
+		if (setup.parallelEvaluation) {
+			ThreadPool::Instance().Parallel_For(indices.size(), evaluateRange);
+		}
+		else {
+			evaluateRange(0, indices.size());
+		}
+	};
+
+	evaluate(setup.coarseObjectiveFunction);
+
+	// the other individuals keep their values - they were inherited from fully evaluated parents (coarse estimates are never inherited)
+	mCoarse_Only.assign(mPopulation.size(), 0);
+	scratch.clear();
+	for (const size_t idx : indices) {
+		mCoarse_Only[idx] = 1;
+		scratch.push_back(mObjectiveValues[idx]);
+	}
+
+	const double threshold = Promotion_Threshold(setup, scratch);
+	std::erase_if(indices, [this, threshold](size_t idx) {
+		return mObjectiveValues[idx] > threshold;
+	});
+
+	evaluate(setup.objectiveFunction);
+	for (const size_t idx : indices) {
+		mCoarse_Only[idx] = 0;
+	}
+
+	// the promoted ones may turn out worse than estimated; the best solution must not be a coarse estimate
+	while (true) {
+		const size_t best = static_cast<size_t>(std::distance(mObjectiveValues.begin(), std::min_element(mObjectiveValues.begin(), mObjectiveValues.end())));
+		if (!mCoarse_Only[best]) {
+			break;
+		}
+		mObjectiveValues[best] = setup.objectiveFunction(mPopulation[best]);
+		mCoarse_Only[best] = 0;
+		indices.push_back(best);
+	}
+
+	return indices.size();
+}
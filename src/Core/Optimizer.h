@@ -10,6 +10,15 @@
 #include <vector>
 #include <functional>
 #include <random>
+#include <chrono>
+#include <limits>
+#include <stop_token>
+#include <span>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "Serialization.h"
 
 #include "../registration.h"
 
@@ -26,17 +35,84 @@ enum class NAction {
 	Abort		// abort optimization
 };
 
+// when should the optimizer deliver the per-iteration (After) callback
+enum class NCallback_Policy {
+	Every_Iteration,	// deliver on every iteration
+	Every_N_Iterations,	// deliver every callbackIterationStep iterations
+	Interval,			// deliver at most once per callbackMinInterval
+	On_Improvement		// deliver only when the best metric improves
+};
+
+// what the optimizer does when the search stagnates
+enum class NStagnation_Action {
+	None,		// keep going until maxIterations
+	Stop,		// stop early with the best solution found
+	Restart		// restart with a fresh, larger population (IPOP); stops once the restarts are exhausted
+};
+
 using TObjective_Fnc = std::function<double(const std::vector<double>& parameters)>;
+// evaluates multiple candidates at once (so the data pass is shared), fills values[i] for candidates[i]
+using TBatch_Objective_Fnc = std::function<void(std::span<const std::vector<double>> candidates, std::span<double> values)>;
+// selects the data subset used by the following objective evaluations (mini-batch); subsetSize = 0 selects the full data
+using TSubset_Fnc = std::function<void(size_t subsetSize, uint64_t seed)>;
+// returns a value that changes whenever the data the objective function evaluates change
+using TData_Revision_Fnc = std::function<uint64_t()>;
 using TCallback_Fnc = std::function<NAction(NCallback_Stage, size_t, double, const std::vector<std::vector<double>>&)>;
+// receives the serialized optimizer state (checkpoint); called from the optimizer thread
+using TCheckpoint_Fnc = std::function<void(std::vector<uint8_t>&& state)>;
 
 /**
  * Setup structure for optimizers
  */
 struct TOptimizer_Setup {
 	size_t maxIterations = 100; // maximum number of iterations
+
+	// budgets, checked after every iteration (the steady-state optimizer checks after every evaluation)
+	size_t maxEvaluations = 0; // maximum number of objective function evaluations; 0 = unlimited
+	std::chrono::milliseconds maxWallTime{ 0 }; // maximum duration of the run (a resumed run starts anew); 0 = unlimited
+	double targetMetric = -std::numeric_limits<double>::infinity(); // stop once the best metric reaches this value
 	size_t populationSize = 50; // for population-based optimizers
 	TObjective_Fnc objectiveFunction; // objective function to minimize
+	TBatch_Objective_Fnc batchObjectiveFunction = nullptr; // optional batch variant of objectiveFunction; population-based optimizers prefer it
 	TCallback_Fnc callbackFunction = nullptr; // optional callback function
+	TData_Revision_Fnc dataRevisionFunction = nullptr; // optional; the cached (e.g., inherited) objective values are re-evaluated when the data change
+
+	NCallback_Policy callbackPolicy = NCallback_Policy::Every_Iteration; // when to deliver the callback; the last iteration is always delivered
+	size_t callbackIterationStep = 1; // for NCallback_Policy::Every_N_Iterations
+	std::chrono::milliseconds callbackMinInterval{ 16 }; // for NCallback_Policy::Interval
+
+	std::stop_token stopToken; // optional cooperative cancellation; checked once per iteration
+
+	bool parallelEvaluation = false; // evaluate the population on the thread pool; the objective function must be thread-safe
+
+	// checkpointing; the state is serialized after an iteration at most once per checkpointInterval, and when the optimization is stopped
+	TCheckpoint_Fnc checkpointFunction = nullptr; // receives the serialized state
+	std::chrono::milliseconds checkpointInterval{ 2000 };
+	std::vector<uint8_t> resumeState; // serialized state to resume from (the run continues as if it was never interrupted); empty = start anew
+
+	// mini-batch evaluation; enabled when subsetFunction is set and miniBatchMinSize > 0
+	TSubset_Fnc subsetFunction = nullptr; // resamples the data subset the objective function evaluates on
+	size_t miniBatchMinSize = 0; // initial subset size
+	size_t miniBatchMaxSize = 0; // the subset grows up to this size as the optimization converges
+	size_t miniBatchGrowthPatience = 50; // iterations without (full data) improvement before the subset grows
+	double miniBatchGrowthFactor = 2.0; // subset growth factor
+	size_t miniBatchEliteInterval = 10; // the best candidate is re-evaluated on the full data every N iterations
+
+	// multi-fidelity evaluation; enabled when coarseObjectiveFunction is set (ignored in mini-batch mode and with the batch objective)
+	// the offspring are scored by the cheap coarse objective first, the ones ranking in the top promotionFraction of the offspring
+	// (by the coarse value, as the levels may be biased against each other) are re-evaluated by objectiveFunction; the best solution
+	// is always a full fidelity one
+	TObjective_Fnc coarseObjectiveFunction = nullptr;
+	double promotionFraction = 0.2;
+
+	// stagnation detection; the search stagnates when the best metric did not improve (relatively, by more than stagnationTolerance)
+	// for stagnationPatience iterations; the patience is cut to a tenth when the population diversity collapses below diversityThreshold
+	NStagnation_Action stagnationAction = NStagnation_Action::None;
+	size_t stagnationPatience = 1000;
+	double stagnationTolerance = 1e-9;
+	double diversityThreshold = 0.0; // mean standard deviation of the parameters relative to their bounds; 0 = disabled
+	size_t maxRestarts = 5; // for NStagnation_Action::Restart
+	double restartPopulationGrowth = 2.0; // population size multiplier on each restart
 
 	std::vector<double> lowerBounds; // lower bounds for each parameter
 	std::vector<double> upperBounds; // upper bounds for each parameter
@@ -45,6 +121,180 @@ struct TOptimizer_Setup {
 	std::vector<double> sensitivity; // sensitivity for each parameter; this is basically the dispersion for a parameter mutation
 };
 
+/**
+ * Decides whether the callback should be delivered in the given iteration, so the optimizer
+ * does not need to prepare callback data (e.g., sorted population) when nobody consumes it
+ */
+class TCallback_Gate {
+	private:
+		const TOptimizer_Setup& mSetup;
+
+		std::chrono::steady_clock::time_point mLast_Delivery{};
+		double mLast_Delivered_Best = std::numeric_limits<double>::infinity();
+
+	public:
+		TCallback_Gate(const TOptimizer_Setup& setup) : mSetup(setup) {}
+
+		bool Should_Deliver(size_t iteration, double bestMetric) {
+			if (!mSetup.callbackFunction) {
+				return false;
+			}
+
+			bool deliver = true;
+			switch (mSetup.callbackPolicy) {
+				case NCallback_Policy::Every_N_Iterations:
+					deliver = (mSetup.callbackIterationStep <= 1) || (iteration % mSetup.callbackIterationStep == 0);
+					break;
+				case NCallback_Policy::Interval:
+					deliver = (std::chrono::steady_clock::now() - mLast_Delivery) >= mSetup.callbackMinInterval;
+					break;
+				case NCallback_Policy::On_Improvement:
+					deliver = bestMetric < mLast_Delivered_Best;
+					break;
+				default:
+					break;
+			}
+
+			// the last iteration is always delivered, so the consumer sees the final state
+			if (iteration + 1 >= mSetup.maxIterations) {
+				deliver = true;
+			}
+
+			if (deliver) {
+				mLast_Delivery = std::chrono::steady_clock::now();
+				mLast_Delivered_Best = bestMetric;
+			}
+
+			return deliver;
+		}
+};
+
+/**
+ * Budget of a single optimization run (see TOptimizer_Setup::maxEvaluations, maxWallTime and targetMetric)
+ */
+class TBudget {
+	private:
+		const TOptimizer_Setup& mSetup;
+		const std::chrono::steady_clock::time_point mStart = std::chrono::steady_clock::now();
+
+	public:
+		TBudget(const TOptimizer_Setup& setup) : mSetup(setup) {}
+
+		bool Exhausted(size_t evaluations, double bestMetric) const {
+			if (mSetup.maxEvaluations > 0 && evaluations >= mSetup.maxEvaluations) {
+				return true;
+			}
+			if (mSetup.maxWallTime.count() > 0 && std::chrono::steady_clock::now() - mStart >= mSetup.maxWallTime) {
+				return true;
+			}
+			return bestMetric <= mSetup.targetMetric;
+		}
+};
+
+/**
+ * Detects stagnation of population-based optimizers (best metric plateau, population diversity collapse)
+ * and decides what to do about it according to the setup
+ */
+class TStagnation_Detector {
+	private:
+		// best metric at the last significant improvement
+		double mReference = std::numeric_limits<double>::infinity();
+		// iterations since the last significant improvement
+		size_t mStall = 0;
+		size_t mRestarts = 0;
+
+		static constexpr size_t Collapsed_Patience_Divisor = 10;
+
+		// mean standard deviation of the parameters relative to their bounds
+		template<typename TPopulation>
+		static double Diversity(const TOptimizer_Setup& setup, const TPopulation& population) {
+			const size_t paramCount = setup.lowerBounds.size();
+			if (population.size() < 2 || paramCount == 0) {
+				return 0.0;
+			}
+
+			double total = 0.0;
+			for (size_t j = 0; j < paramCount; j++) {
+				double mean = 0.0;
+				for (const auto& individual : population) {
+					mean += individual[j];
+				}
+				mean /= static_cast<double>(population.size());
+
+				double variance = 0.0;
+				for (const auto& individual : population) {
+					variance += (individual[j] - mean) * (individual[j] - mean);
+				}
+				variance /= static_cast<double>(population.size());
+
+				const double range = setup.upperBounds[j] - setup.lowerBounds[j];
+				total += range > 0.0 ? std::sqrt(variance) / range : 0.0;
+			}
+			return total / static_cast<double>(paramCount);
+		}
+
+	public:
+		// called once per iteration; returns the action to take (None if the search goes on)
+		template<typename TPopulation>
+		NStagnation_Action Update(const TOptimizer_Setup& setup, double bestMetric, const TPopulation& population) {
+			if (setup.stagnationAction == NStagnation_Action::None) {
+				return NStagnation_Action::None;
+			}
+
+			const bool improved = std::isfinite(mReference) ? (bestMetric < mReference - setup.stagnationTolerance * std::abs(mReference)) : (bestMetric < mReference);
+			// the best metric never gets worse on the same data - the data changed (e.g., points added during the run),
+			// so the search starts over from the new level instead of counting the time spent on the old data
+			if (improved || bestMetric > mReference) {
+				mReference = bestMetric;
+				mStall = 0;
+			}
+			else {
+				mStall++;
+			}
+
+			// a collapsed population may still improve slowly, but it hardly escapes a local minimum - it gets a tenth of the patience
+			size_t patience = setup.stagnationPatience;
+			if (setup.diversityThreshold > 0.0 && mStall > 0 && Diversity(setup, population) < setup.diversityThreshold) {
+				patience /= Collapsed_Patience_Divisor;
+			}
+			if (patience == 0 || mStall < patience) {
+				return NStagnation_Action::None;
+			}
+
+			if (setup.stagnationAction == NStagnation_Action::Restart && mRestarts < setup.maxRestarts) {
+				mRestarts++;
+				mStall = 0;
+				return NStagnation_Action::Restart;
+			}
+			return NStagnation_Action::Stop;
+		}
+
+		// population size after the next restart
+		static size_t Restart_Population_Size(const TOptimizer_Setup& setup, size_t currentSize) {
+			return std::max(currentSize, static_cast<size_t>(static_cast<double>(currentSize) * std::max(1.0, setup.restartPopulationGrowth)));
+		}
+
+		size_t Restarts() const {
+			return mRestarts;
+		}
+
+		void Save(TBinary_Writer& writer) const {
+			writer.Write(mReference);
+			writer.Write<uint64_t>(mStall);
+			writer.Write<uint64_t>(mRestarts);
+		}
+
+		bool Load(TBinary_Reader& reader) {
+			uint64_t stall = 0, restarts = 0;
+			if (!reader.Read(mReference) || !reader.Read(stall) || !reader.Read(restarts)) {
+				return false;
+			}
+			mStall = static_cast<size_t>(stall);
+			mRestarts = static_cast<size_t>(restarts);
+			return true;
+		}
+};
+
 /**
  * Base class for optimizers
  */
@@ -58,12 +308,25 @@ class Optimizer {
 		std::vector<double> mObjectiveValues;
 		// next population (to be swapped with the current one once the iteration is done)
 		std::vector<std::vector<double>> mPopulation_Next;
+		// 1 = the objective value of the individual is a coarse estimate (multi-fidelity evaluation); empty = none is
+		std::vector<uint8_t> mCoarse_Only;
 
 	protected:
 		// random generator
 		std::random_device mRandDev;
 		std::mt19937 mRandGen{ mRandDev() };
 
+		// store the population, objective values and the random generator state
+		void Save_Base_State(TBinary_Writer& writer) const;
+		// restore the state stored by Save_Base_State, returns false if the data are invalid
+		bool Load_Base_State(TBinary_Reader& reader, size_t paramCount);
+
+		// coarse value an offspring has to reach to be promoted to the full fidelity evaluation; values are the coarse values of
+		// the offspring it ranks among (reordered)
+		static double Promotion_Threshold(const TOptimizer_Setup& setup, std::vector<double>& values);
+		// multi-fidelity evaluation of the given individuals; indices are left with the promoted ones (returns their count)
+		size_t Evaluate_Multi_Fidelity(const TOptimizer_Setup& setup, std::vector<size_t>& indices, std::vector<double>& scratch);
+
 	public:
 		Optimizer() = default;
 		virtual ~Optimizer() = default;
@@ -0,0 +1,111 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "PerfCounters.h"
+
+#include <bit>
+#include <algorithm>
+
+size_t PerfCounters::Bucket_Index(uint64_t ns) {
+	if (ns < Sub_Buckets) {
+		return static_cast<size_t>(ns);
+	}
+
+	// exponent and the two bits right below the leading one select the bucket
+	const size_t exponent = static_cast<size_t>(std::bit_width(ns)) - 1;
+	const size_t sub = static_cast<size_t>((ns >> (exponent - 2)) & (Sub_Buckets - 1));
+
+	return std::min(exponent * Sub_Buckets + sub, Bucket_Count - 1);
+}
+
+double PerfCounters::Bucket_Upper_Bound_Ns(size_t bucket) {
+	if (bucket < Sub_Buckets) {
+		return static_cast<double>(bucket + 1);
+	}
+	// exponent 1 has no sub-buckets (the values below Sub_Buckets are counted exactly), these buckets stay empty
+	if (bucket < 2 * Sub_Buckets) {
+		return static_cast<double>(Sub_Buckets);
+	}
+
+	const size_t exponent = bucket / Sub_Buckets;
+	const size_t sub = bucket % Sub_Buckets;
+
+	return static_cast<double>(Sub_Buckets + sub + 1) * static_cast<double>(1ULL << (exponent - 2));
+}
+
+void PerfCounters::Record(NPerf_Counter counter, uint64_t durationNs, size_t sampleCount) {
+	auto& metric = mMetrics[static_cast<size_t>(counter)];
+
+	metric.count.fetch_add(sampleCount, std::memory_order_relaxed);
+	metric.totalNs.fetch_add(durationNs, std::memory_order_relaxed);
+	metric.histogram[Bucket_Index(durationNs / sampleCount)].fetch_add(static_cast<uint32_t>(sampleCount), std::memory_order_relaxed);
+}
+
+TPerf_Snapshot PerfCounters::Snapshot() {
+	std::lock_guard<std::mutex> lock(mSnapshot_Mutex);
+
+	const auto now = std::chrono::steady_clock::now();
+	const double windowSecs = std::max(1e-9, std::chrono::duration<double>(now - mLast_Snapshot_Time).count());
+	mLast_Snapshot_Time = now;
+
+	TPerf_Snapshot snapshot;
+
+	for (size_t m = 0; m < mMetrics.size(); m++) {
+		auto& metric = mMetrics[m];
+		auto& window = mLast_Window[m];
+		auto& stats = snapshot.metrics[m];
+
+		const uint64_t count = metric.count.load(std::memory_order_relaxed);
+		const uint64_t totalNs = metric.totalNs.load(std::memory_order_relaxed);
+
+		stats.count = count - window.count;
+		stats.ratePerSec = static_cast<double>(stats.count) / windowSecs;
+		stats.meanUs = stats.count > 0 ? static_cast<double>(totalNs - window.totalNs) / static_cast<double>(stats.count) / 1000.0 : 0.0;
+
+		window.count = count;
+		window.totalNs = totalNs;
+
+		// the histogram is not read atomically as a whole, so the percentile is approximate (which is fine for a HUD)
+		std::array<uint32_t, Bucket_Count> delta{};
+		uint64_t histogramTotal = 0;
+		for (size_t b = 0; b < Bucket_Count; b++) {
+			const uint32_t value = metric.histogram[b].load(std::memory_order_relaxed);
+			delta[b] = value - window.histogram[b];
+			window.histogram[b] = value;
+			histogramTotal += delta[b];
+		}
+
+		if (histogramTotal > 0) {
+			const uint64_t threshold = (histogramTotal * 99 + 99) / 100;
+			uint64_t cumulative = 0;
+			for (size_t b = 0; b < Bucket_Count; b++) {
+				cumulative += delta[b];
+				if (cumulative >= threshold) {
+					stats.p99Us = Bucket_Upper_Bound_Ns(b) / 1000.0;
+					break;
+				}
+			}
+		}
+	}
+
+	return snapshot;
+}
+
+void PerfCounters::Reset() {
+	std::lock_guard<std::mutex> lock(mSnapshot_Mutex);
+
+	for (size_t m = 0; m < mMetrics.size(); m++) {
+		mMetrics[m].count = 0;
+		mMetrics[m].totalNs = 0;
+		for (auto& bucket : mMetrics[m].histogram) {
+			bucket = 0;
+		}
+		mLast_Window[m] = TMetric_Window{};
+	}
+
+	mLast_Snapshot_Time = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,133 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+
+#include "ObjectAccessor.h"
+
+// measured metrics
+enum class NPerf_Counter {
+	Evaluation,	// single objective function evaluation
+	Generation,	// single optimizer iteration (without callback)
+	Callback,	// optimizer callback delivery
+	Frame,		// application frame (update + render)
+
+	count
+};
+
+// windowed statistics of a single metric
+struct TPerf_Metric_Stats {
+	uint64_t count = 0;			// number of samples in the window
+	double ratePerSec = 0.0;	// samples per second in the window
+	double meanUs = 0.0;		// mean duration in microseconds
+	double p99Us = 0.0;			// 99th percentile of duration in microseconds (histogram resolution)
+};
+
+// snapshot of all metrics
+struct TPerf_Snapshot {
+	std::array<TPerf_Metric_Stats, static_cast<size_t>(NPerf_Counter::count)> metrics{};
+
+	const TPerf_Metric_Stats& operator[](NPerf_Counter counter) const {
+		return metrics[static_cast<size_t>(counter)];
+	}
+};
+
+/**
+ * Lightweight performance counters; recording is lock-free and costs a single relaxed load when disabled
+ */
+class PerfCounters : public IObject {
+	private:
+		// log-scale histogram: 4 sub-buckets per power of two nanoseconds
+		static constexpr size_t Sub_Buckets = 4;
+		static constexpr size_t Bucket_Count = 64 * Sub_Buckets;
+
+		struct TMetric {
+			std::atomic<uint64_t> count{ 0 };
+			std::atomic<uint64_t> totalNs{ 0 };
+			std::array<std::atomic<uint32_t>, Bucket_Count> histogram{};
+		};
+
+		// state of the previous snapshot, so the statistics are windowed
+		struct TMetric_Window {
+			uint64_t count = 0;
+			uint64_t totalNs = 0;
+			std::array<uint32_t, Bucket_Count> histogram{};
+		};
+
+		inline static std::atomic<bool> mEnabled{ false };
+
+		std::array<TMetric, static_cast<size_t>(NPerf_Counter::count)> mMetrics;
+
+		std::mutex mSnapshot_Mutex;
+		std::array<TMetric_Window, static_cast<size_t>(NPerf_Counter::count)> mLast_Window;
+		std::chrono::steady_clock::time_point mLast_Snapshot_Time = std::chrono::steady_clock::now();
+
+		static size_t Bucket_Index(uint64_t ns);
+		static double Bucket_Upper_Bound_Ns(size_t bucket);
+
+	public:
+		PerfCounters() = default;
+		~PerfCounters() override = default;
+
+		static PerfCounters& Instance() {
+			return CObjectAccessor::get<PerfCounters>();
+		}
+
+		static bool Is_Enabled() {
+			return mEnabled.load(std::memory_order_relaxed);
+		}
+
+		static void Set_Enabled(bool enabled) {
+			mEnabled.store(enabled, std::memory_order_relaxed);
+		}
+
+		// record a single sample of the given metric; a duration covering multiple samples (e.g., batch evaluation) is split evenly
+		void Record(NPerf_Counter counter, uint64_t durationNs, size_t sampleCount = 1);
+
+		// statistics since the previous snapshot
+		TPerf_Snapshot Snapshot();
+
+		// reset all metrics
+		void Reset();
+};
+
+/**
+ * RAII scope measuring its own duration into the given metric (if counters are enabled)
+ */
+class TPerf_Scope {
+	private:
+		NPerf_Counter mCounter;
+		size_t mSample_Count;
+		bool mActive;
+		std::chrono::steady_clock::time_point mStart;
+
+	public:
+		TPerf_Scope(NPerf_Counter counter, size_t sampleCount = 1) : mCounter(counter), mSample_Count(sampleCount), mActive(PerfCounters::Is_Enabled() && sampleCount > 0) {
+			if (mActive) {
+				mStart = std::chrono::steady_clock::now();
+			}
+		}
+
+		~TPerf_Scope() {
+			Stop();
+		}
+
+		// record the measurement now instead of at the end of the scope
+		void Stop() {
+			if (mActive) {
+				mActive = false;
+				const auto elapsed = std::chrono::steady_clock::now() - mStart;
+				PerfCounters::Instance().Record(mCounter, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), mSample_Count);
+			}
+		}
+};
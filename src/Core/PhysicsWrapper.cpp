@@ -1,39 +1,57 @@
 #include "PhysicsWrapper.h"
+#include "Trace.h"
 
 #include "raylib.h"
 
-constexpr float Screen_To_Physics_Scale = 0.01f;
-constexpr float Physics_To_Screen_Scale = 1.0f / Screen_To_Physics_Scale;
+namespace {
+	// Box2D keeps the worlds in a global registry, creating and destroying them is not thread-safe (stepping distinct worlds is)
+	std::mutex World_Registry_Mutex;
+}
+
+float PhysicsWorld::Get_Time_Step(NPhysics_Fidelity fidelity) {
+	return fidelity == NPhysics_Fidelity::Coarse ? 1.0f / 30.0f : 1.0f / 60.0f;
+}
+
+int PhysicsWorld::Get_Sub_Steps(NPhysics_Fidelity fidelity) {
+	return fidelity == NPhysics_Fidelity::Coarse ? 1 : 4;
+}
+
+std::array<Rectangle, 3> PhysicsWorld::Get_Boundary_Rects() {
+	const float width = static_cast<float>(GetScreenWidth());
+	const float height = static_cast<float>(GetScreenHeight());
+
+	return {
+		Rectangle{ -width, -height / 2.0f - Physics_To_Screen_Scale, 2.0f * width, 2.0f * Physics_To_Screen_Scale }, // ground
+		Rectangle{ -1.0f, -height, 2.0f, 2.0f * height }, // left wall
+		Rectangle{ width - 1.0f, -height, 2.0f, 2.0f * height } // right wall
+	};
+}
+
+PhysicsWorld::PhysicsWorld(const PhysicsConfig& cfg)
+	: mTime_Step(Get_Time_Step(cfg.fidelity)), mSub_Steps(Get_Sub_Steps(cfg.fidelity)) {
 
-PhysicsWorld::PhysicsWorld(const PhysicsConfig& cfg) {
 	b2WorldDef worldDef = b2DefaultWorldDef();
 
 	worldDef.gravity = cfg.gravity;
 
-	mWorldId = b2CreateWorld(&worldDef);
-
-	b2BodyDef groundBodyDef = b2DefaultBodyDef();
-	groundBodyDef.position = { 0.0f, Screen_To_Physics_Scale*(- GetScreenHeight() / 2.0f)};
-	b2BodyId groundId = b2CreateBody(mWorldId, &groundBodyDef);
-
-	b2Polygon groundBox = b2MakeBox(Screen_To_Physics_Scale*GetScreenWidth(), 1.0f);
-	b2ShapeDef groundShapeDef = b2DefaultShapeDef();
-	b2CreatePolygonShape(groundId, &groundShapeDef, &groundBox);
-
-	// add sides to collide with the ball
-	b2Polygon leftWallBox = b2MakeBox(Screen_To_Physics_Scale * 1.0f, Screen_To_Physics_Scale * GetScreenHeight());
-	b2BodyDef leftWallBodyDef = b2DefaultBodyDef();
-	leftWallBodyDef.position = { 0, 0.0f };
-	b2BodyId leftWallId = b2CreateBody(mWorldId, &leftWallBodyDef);
-	b2CreatePolygonShape(leftWallId, &groundShapeDef, &leftWallBox);
-	b2Polygon rightWallBox = b2MakeBox(Screen_To_Physics_Scale * 1.0f, Screen_To_Physics_Scale * GetScreenHeight());
-	b2BodyDef rightWallBodyDef = b2DefaultBodyDef();
-	rightWallBodyDef.position = { Screen_To_Physics_Scale*GetScreenWidth(), 0.0f};
-	b2BodyId rightWallId = b2CreateBody(mWorldId, &rightWallBodyDef);
-	b2CreatePolygonShape(rightWallId, &groundShapeDef, &rightWallBox);
+	{
+		std::lock_guard<std::mutex> lock(World_Registry_Mutex);
+		mWorldId = b2CreateWorld(&worldDef);
+	}
+
+	// ground and sides to collide with the ball (shared with the analytic trajectory checks, see Get_Boundary_Rects)
+	const b2ShapeDef shapeDef = b2DefaultShapeDef();
+	for (const auto& rect : Get_Boundary_Rects()) {
+		b2BodyDef bodyDef = b2DefaultBodyDef();
+		bodyDef.position = { Screen_To_Physics_Scale * (rect.x + rect.width / 2.0f), Screen_To_Physics_Scale * (rect.y + rect.height / 2.0f) };
+		b2BodyId bodyId = b2CreateBody(mWorldId, &bodyDef);
+		b2Polygon box = b2MakeBox(Screen_To_Physics_Scale * rect.width / 2.0f, Screen_To_Physics_Scale * rect.height / 2.0f);
+		b2CreatePolygonShape(bodyId, &shapeDef, &box);
+	}
 }
 
 PhysicsWorld::~PhysicsWorld() {
+	std::lock_guard<std::mutex> lock(World_Registry_Mutex);
 	b2DestroyWorld(mWorldId);
 }
 
@@ -68,11 +86,16 @@ void PhysicsWorld::Add_Dynamic_Ball_Body(float x, float y, float radius, float i
 	mDynamicBallId = bodyId;
 }
 
+void PhysicsWorld::Step() {
+	Step(mTime_Step);
+}
+
 void PhysicsWorld::Step(float timeStep) {
+	TRACE_SCOPE("PhysicsWorld::Step");
 
 	std::unique_lock<std::mutex> lock(mMutex);
 
-	b2World_Step(mWorldId, timeStep, 4);
+	b2World_Step(mWorldId, timeStep, mSub_Steps);
 
 	if (mDynamicBallId.index1 != -1) {
 		b2Vec2 position = b2Body_GetPosition(mDynamicBallId);
@@ -11,10 +11,21 @@
 #include "raylib.h"
 
 #include <vector>
+#include <array>
 #include <mutex>
 
+constexpr float Screen_To_Physics_Scale = 0.01f;
+constexpr float Physics_To_Screen_Scale = 1.0f / Screen_To_Physics_Scale;
+
+// accuracy of the simulation; the coarse level is meant for cheap screening of candidates
+enum class NPhysics_Fidelity {
+	Coarse,	// 1/30 s time step, single substep
+	Full	// 1/60 s time step, 4 substeps
+};
+
 struct PhysicsConfig {
 	b2Vec2 gravity = { 0, 1.0f };
+	NPhysics_Fidelity fidelity = NPhysics_Fidelity::Full;
 };
 
 class PhysicsWorld {
@@ -25,6 +36,9 @@ class PhysicsWorld {
 
 		std::vector<Vector2> mBallPositions;
 
+		float mTime_Step;
+		int mSub_Steps;
+
 		std::mutex mMutex;
 
 	public:
@@ -36,8 +50,16 @@ class PhysicsWorld {
 		// x and y are screen coordinates
 		void Add_Dynamic_Ball_Body(float x, float y, float radius, float initialDirection = 0, float initialVelocity = 0, float density = 1.0f);
 
+		// step by the time step of the fidelity level
+		void Step();
 		void Step(float timeStep);
 
+		static float Get_Time_Step(NPhysics_Fidelity fidelity);
+		static int Get_Sub_Steps(NPhysics_Fidelity fidelity);
+
+		// static bodies every world contains (the ground above the screen and the side walls), in screen coordinates
+		static std::array<Rectangle, 3> Get_Boundary_Rects();
+
 		const std::vector<Vector2>& Get_Ball_Positions() const { return mBallPositions; }
 
 		void Reset();
@@ -0,0 +1,240 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "PointCloud.h"
+#include "Trace.h"
+
+#include "rlgl.h"
+#include "raymath.h"
+
+#include <array>
+#include <numbers>
+#include <cmath>
+#include <string>
+#include <cstddef>
+
+namespace {
+	// segments of the circle mesh; the points are small, so this is plenty
+	constexpr int Circle_Segments = 12;
+	constexpr int Circle_Vertex_Count = Circle_Segments * 3;
+
+	constexpr const char* Vertex_Shader_Body = R"(
+in vec2 vertexPosition;
+in vec2 instancePosition;
+in vec4 instanceColor;
+uniform mat4 mvp;
+uniform float radius;
+out vec4 fragColor;
+void main() {
+	fragColor = instanceColor;
+	gl_Position = mvp * vec4(instancePosition + vertexPosition * radius, 0.0, 1.0);
+}
+)";
+
+	constexpr const char* Fragment_Shader_Body = R"(
+in vec4 fragColor;
+out vec4 finalColor;
+void main() {
+	finalColor = fragColor;
+}
+)";
+
+	// unit circle as a triangle list
+	std::array<float, Circle_Vertex_Count * 2> Build_Circle_Mesh() {
+		std::array<float, Circle_Vertex_Count * 2> mesh{};
+		for (int i = 0; i < Circle_Segments; i++) {
+			const double a0 = 2.0 * std::numbers::pi * i / Circle_Segments;
+			const double a1 = 2.0 * std::numbers::pi * (i + 1) / Circle_Segments;
+			float* tri = mesh.data() + i * 6;
+			tri[0] = 0.0f;
+			tri[1] = 0.0f;
+			tri[2] = static_cast<float>(std::cos(a1));
+			tri[3] = static_cast<float>(std::sin(a1));
+			tri[4] = static_cast<float>(std::cos(a0));
+			tri[5] = static_cast<float>(std::sin(a0));
+		}
+		return mesh;
+	}
+}
+
+struct TPoint_Cloud::TShader {
+	unsigned int id = 0;
+	int vertexPositionLoc = -1;
+	int instancePositionLoc = -1;
+	int instanceColorLoc = -1;
+	int mvpLoc = -1;
+	int radiusLoc = -1;
+
+	TShader() {
+		// desktop GL 3.3 or WebGL 2 (the only contexts with instancing)
+		const std::string header = (rlGetVersion() == RL_OPENGL_ES_30) ? "#version 300 es\nprecision mediump float;\n" : "#version 330\n";
+		const std::string vs = header + Vertex_Shader_Body;
+		const std::string fs = header + Fragment_Shader_Body;
+
+		id = rlLoadShaderCode(vs.c_str(), fs.c_str());
+		if (id == 0 || id == rlGetShaderIdDefault()) {
+			id = 0;
+			return;
+		}
+
+		vertexPositionLoc = rlGetLocationAttrib(id, "vertexPosition");
+		instancePositionLoc = rlGetLocationAttrib(id, "instancePosition");
+		instanceColorLoc = rlGetLocationAttrib(id, "instanceColor");
+		mvpLoc = rlGetLocationUniform(id, "mvp");
+		radiusLoc = rlGetLocationUniform(id, "radius");
+	}
+
+	~TShader() {
+		if (id != 0) {
+			rlUnloadShaderProgram(id);
+		}
+	}
+
+	bool Is_Valid() const {
+		return id != 0 && vertexPositionLoc >= 0 && instancePositionLoc >= 0 && instanceColorLoc >= 0;
+	}
+
+	// the shader is released with the last point cloud (while the graphics context still exists)
+	static std::shared_ptr<TShader> Acquire() {
+		static std::weak_ptr<TShader> shared;
+		auto shader = shared.lock();
+		if (!shader) {
+			shader = std::make_shared<TShader>();
+			shared = shader;
+		}
+		return shader;
+	}
+};
+
+TPoint_Cloud::~TPoint_Cloud() {
+	Release_GPU();
+}
+
+bool TPoint_Cloud::Is_Instancing_Supported() {
+	const int version = rlGetVersion();
+	return version == RL_OPENGL_33 || version == RL_OPENGL_43 || version == RL_OPENGL_ES_30;
+}
+
+void TPoint_Cloud::Resize(size_t count) {
+	const size_t oldCount = mInstances.size();
+	mInstances.resize(count);
+	if (count > oldCount) {
+		Mark_Dirty(oldCount, count);
+	}
+}
+
+void TPoint_Cloud::Clear() {
+	mInstances.clear();
+	mDirty_Begin = std::numeric_limits<size_t>::max();
+	mDirty_End = 0;
+	mSynced_Reset_Revision = std::numeric_limits<uint64_t>::max();
+}
+
+bool TPoint_Cloud::Init_GPU() {
+	if (mVao != 0) {
+		return true;
+	}
+
+	if (!mShader) {
+		mShader = TShader::Acquire();
+	}
+	if (!mShader->Is_Valid()) {
+		return false;
+	}
+
+	static const auto circleMesh = Build_Circle_Mesh();
+
+	mVao = rlLoadVertexArray();
+	rlEnableVertexArray(mVao);
+
+	mMesh_Vbo = rlLoadVertexBuffer(circleMesh.data(), static_cast<int>(sizeof(circleMesh)), false);
+	rlSetVertexAttribute(mShader->vertexPositionLoc, 2, RL_FLOAT, false, 0, 0);
+	rlEnableVertexAttribute(mShader->vertexPositionLoc);
+
+	rlDisableVertexArray();
+
+	return true;
+}
+
+void TPoint_Cloud::Release_GPU() {
+	if (mInstance_Vbo != 0) {
+		rlUnloadVertexBuffer(mInstance_Vbo);
+	}
+	if (mMesh_Vbo != 0) {
+		rlUnloadVertexBuffer(mMesh_Vbo);
+	}
+	if (mVao != 0) {
+		rlUnloadVertexArray(mVao);
+	}
+	mInstance_Vbo = 0;
+	mMesh_Vbo = 0;
+	mVao = 0;
+	mInstance_Capacity = 0;
+}
+
+void TPoint_Cloud::Upload() {
+	if (mInstances.size() > mInstance_Capacity) {
+		// grow geometrically, so the buffer is not re-created on every added point
+		if (mInstance_Vbo != 0) {
+			rlUnloadVertexBuffer(mInstance_Vbo);
+		}
+		mInstance_Capacity = std::max<size_t>(1024, mInstances.size() * 2);
+
+		rlEnableVertexArray(mVao);
+		mInstance_Vbo = rlLoadVertexBuffer(nullptr, static_cast<int>(mInstance_Capacity * sizeof(TInstance)), true);
+		rlSetVertexAttribute(mShader->instancePositionLoc, 2, RL_FLOAT, false, sizeof(TInstance), offsetof(TInstance, x));
+		rlEnableVertexAttribute(mShader->instancePositionLoc);
+		rlSetVertexAttributeDivisor(mShader->instancePositionLoc, 1);
+		rlSetVertexAttribute(mShader->instanceColorLoc, 4, RL_UNSIGNED_BYTE, true, sizeof(TInstance), offsetof(TInstance, color));
+		rlEnableVertexAttribute(mShader->instanceColorLoc);
+		rlSetVertexAttributeDivisor(mShader->instanceColorLoc, 1);
+		rlDisableVertexArray();
+
+		// the new buffer is empty
+		mDirty_Begin = 0;
+		mDirty_End = mInstances.size();
+	}
+
+	mDirty_End = std::min(mDirty_End, mInstances.size());
+	if (mDirty_Begin < mDirty_End) {
+		rlUpdateVertexBuffer(mInstance_Vbo, mInstances.data() + mDirty_Begin, static_cast<int>((mDirty_End - mDirty_Begin) * sizeof(TInstance)),
+			static_cast<int>(mDirty_Begin * sizeof(TInstance)));
+	}
+
+	mDirty_Begin = std::numeric_limits<size_t>::max();
+	mDirty_End = 0;
+}
+
+void TPoint_Cloud::Draw(float radius) {
+	if (mInstances.empty()) {
+		return;
+	}
+
+	TRACE_SCOPE("PointCloud::Draw");
+
+	if (!Is_Instancing_Supported() || !Init_GPU()) {
+		for (const auto& instance : mInstances) {
+			DrawCircleV({ instance.x, instance.y }, radius, instance.color);
+		}
+		return;
+	}
+
+	Upload();
+
+	// flush the pending batch, so the draw order is kept
+	rlDrawRenderBatchActive();
+
+	rlEnableShader(mShader->id);
+	rlSetUniformMatrix(mShader->mvpLoc, MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection()));
+	rlSetUniform(mShader->radiusLoc, &radius, RL_SHADER_UNIFORM_FLOAT, 1);
+
+	rlEnableVertexArray(mVao);
+	rlDrawVertexArrayInstanced(0, Circle_Vertex_Count, static_cast<int>(mInstances.size()));
+	rlDisableVertexArray();
+
+	rlDisableShader();
+}
@@ -0,0 +1,106 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+#include "raylib.h"
+#include "Dataset.h"
+
+/**
+ * Point cloud renderer - points (filled circles) are kept in a vertex buffer and drawn by a single instanced draw call
+ * Only the changed range of points is uploaded before drawing. Without instancing support (OpenGL ES 2 / WebGL 1),
+ * the points are drawn one by one
+ */
+class TPoint_Cloud {
+	private:
+		struct TInstance {
+			float x;
+			float y;
+			Color color;
+		};
+
+		// shader shared by all the point clouds
+		struct TShader;
+		std::shared_ptr<TShader> mShader;
+
+		std::vector<TInstance> mInstances;
+
+		// GPU resources (0 = not created)
+		unsigned int mVao = 0;
+		unsigned int mMesh_Vbo = 0;
+		unsigned int mInstance_Vbo = 0;
+		size_t mInstance_Capacity = 0;
+
+		// range of instances changed since the last upload
+		size_t mDirty_Begin = std::numeric_limits<size_t>::max();
+		size_t mDirty_End = 0;
+
+		// state of the point set the cloud was synchronized with
+		uint64_t mSynced_Reset_Revision = std::numeric_limits<uint64_t>::max();
+
+		void Mark_Dirty(size_t begin, size_t end) {
+			mDirty_Begin = std::min(mDirty_Begin, begin);
+			mDirty_End = std::max(mDirty_End, end);
+		}
+
+		bool Init_GPU();
+		void Release_GPU();
+		void Upload();
+
+	public:
+		TPoint_Cloud() = default;
+		virtual ~TPoint_Cloud();
+
+		TPoint_Cloud(const TPoint_Cloud&) = delete;
+		TPoint_Cloud& operator=(const TPoint_Cloud&) = delete;
+
+		// is the instanced path available in the current graphics context?
+		static bool Is_Instancing_Supported();
+
+		size_t Size() const {
+			return mInstances.size();
+		}
+
+		// resizes the cloud, keeping the existing points
+		void Resize(size_t count);
+
+		void Set(size_t index, const Vector2& position, Color color) {
+			mInstances[index] = { position.x, position.y, color };
+			Mark_Dirty(index, index + 1);
+		}
+
+		void Clear();
+
+		// synchronizes the cloud with the point set, positions are mapped by the transform; points appended
+		// since the last synchronization are the only ones updated, unless the point set was reset
+		template<typename TTransform>
+		void Sync(const TPoint_Set& points, Color color, TTransform&& transform) {
+			size_t first = mInstances.size();
+			if (points.Reset_Revision() != mSynced_Reset_Revision || points.size() < mInstances.size()) {
+				mSynced_Reset_Revision = points.Reset_Revision();
+				first = 0;
+			}
+
+			Resize(points.size());
+			for (size_t i = first; i < points.size(); i++) {
+				Set(i, transform(points[i]), color);
+			}
+		}
+
+		void Sync(const TPoint_Set& points, Color color) {
+			Sync(points, color, [](const Vector2& point) { return point; });
+		}
+
+		// draws all the points as circles of the given radius
+		void Draw(float radius);
+};
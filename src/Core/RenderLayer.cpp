@@ -0,0 +1,56 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "RenderLayer.h"
+
+#include "rlgl.h"
+
+TRender_Layer::~TRender_Layer() {
+	if (mLoaded) {
+		UnloadRenderTexture(mTarget);
+	}
+}
+
+bool TRender_Layer::Ensure_Target(int width, int height) {
+	if (mLoaded && mTarget.texture.width == width && mTarget.texture.height == height) {
+		return false;
+	}
+
+	if (mLoaded) {
+		UnloadRenderTexture(mTarget);
+	}
+
+	mTarget = LoadRenderTexture(width, height);
+	mLoaded = true;
+	return true;
+}
+
+void TRender_Layer::Begin_Rasterize() {
+	BeginTextureMode(mTarget);
+	ClearBackground(BLANK);
+
+	// color blended as usual, alpha accumulated - the texture then holds premultiplied alpha
+	rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD, RL_FUNC_ADD);
+	BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+}
+
+void TRender_Layer::End_Rasterize() {
+	EndBlendMode();
+	EndTextureMode();
+}
+
+void TRender_Layer::Draw(int x, int y) const {
+	if (!mLoaded) {
+		return;
+	}
+
+	// render textures are stored upside down
+	const Rectangle source = { 0.0f, 0.0f, static_cast<float>(mTarget.texture.width), -static_cast<float>(mTarget.texture.height) };
+	BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+	DrawTextureRec(mTarget.texture, source, { static_cast<float>(x), static_cast<float>(y) }, WHITE);
+	EndBlendMode();
+}
@@ -0,0 +1,69 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "raylib.h"
+#include "Trace.h"
+
+/**
+ * Retained render layer - static content rasterized into a render texture, which is re-rasterized only when
+ * the content revision (or the layer size) changes, and composited every frame
+ * The texture holds premultiplied alpha, so the antialiased edges (e.g., of text) composite the same as when drawn directly
+ */
+class TRender_Layer {
+	private:
+		RenderTexture2D mTarget{};
+		bool mLoaded = false;
+
+		// revision of the content the texture holds
+		uint64_t mRevision = std::numeric_limits<uint64_t>::max();
+
+		// (re)creates the render texture if the size changed; returns true if so (the content is lost)
+		bool Ensure_Target(int width, int height);
+
+		void Begin_Rasterize();
+		void End_Rasterize();
+
+	public:
+		TRender_Layer() = default;
+		virtual ~TRender_Layer();
+
+		TRender_Layer(const TRender_Layer&) = delete;
+		TRender_Layer& operator=(const TRender_Layer&) = delete;
+
+		// re-rasterizes the layer if the revision changed; drawFnc draws the content in layer coordinates (origin at the top left)
+		template<typename TFnc>
+		void Update(int width, int height, uint64_t revision, TFnc&& drawFnc) {
+			if (Ensure_Target(width, height) || revision != mRevision) {
+				TRACE_SCOPE("RenderLayer::Rasterize");
+
+				mRevision = revision;
+				Begin_Rasterize();
+				drawFnc();
+				End_Rasterize();
+			}
+		}
+
+		// screen-sized layer
+		template<typename TFnc>
+		void Update(uint64_t revision, TFnc&& drawFnc) {
+			Update(GetScreenWidth(), GetScreenHeight(), revision, std::forward<TFnc>(drawFnc));
+		}
+
+		// forces re-rasterization on the next update
+		void Invalidate() {
+			mRevision = std::numeric_limits<uint64_t>::max();
+		}
+
+		// composite the layer to the current target
+		void Draw(int x = 0, int y = 0) const;
+};
@@ -0,0 +1,113 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <random>
+#include <cmath>
+#include <numbers>
+#include <limits>
+
+#include "Serialization.h"
+
+namespace Sampling {
+
+	// uniform number in the open interval (0, 1) from a single generator draw
+	inline double Uniform_Open(std::mt19937& generator) {
+		return (static_cast<double>(generator()) + 0.5) * (1.0 / 4294967296.0);
+	}
+
+	/**
+	 * Skips over Bernoulli(p) trials: returns the number of failures before the next success, so the caller
+	 * can jump directly to the next success instead of drawing a random number for every trial
+	 */
+	class TGeometric_Skip {
+		private:
+			double mProbability = 0.0;
+			// 1 / log(1 - p)
+			double mInv_Log_Q = 0.0;
+
+		public:
+			explicit TGeometric_Skip(double probability = 0.0) {
+				Set_Probability(probability);
+			}
+
+			void Set_Probability(double probability) {
+				mProbability = probability;
+				mInv_Log_Q = (probability > 0.0 && probability < 1.0) ? 1.0 / std::log1p(-probability) : 0.0;
+			}
+
+			size_t Next(std::mt19937& generator) const {
+				if (mProbability <= 0.0) {
+					return std::numeric_limits<size_t>::max();
+				}
+				if (mProbability >= 1.0) {
+					return 0;
+				}
+
+				const double skip = std::floor(std::log(Uniform_Open(generator)) * mInv_Log_Q);
+				return skip < static_cast<double>(std::numeric_limits<size_t>::max() / 2) ? static_cast<size_t>(skip) : std::numeric_limits<size_t>::max() / 2;
+			}
+	};
+
+	/**
+	 * Standard normal variates generated in batches by the Box-Muller transform (both variates of a pair are used);
+	 * the uniform draws and the transform are separate loops, so the transform loop may be vectorized
+	 */
+	class TGaussian_Batch {
+		private:
+			static constexpr size_t Batch_Size = 256;
+
+			std::array<double, Batch_Size> mValues{};
+			size_t mNext = Batch_Size;
+
+			void Refill(std::mt19937& generator) {
+				constexpr size_t pairCount = Batch_Size / 2;
+
+				std::array<double, pairCount> radius;
+				std::array<double, pairCount> angle;
+				for (size_t i = 0; i < pairCount; i++) {
+					radius[i] = Uniform_Open(generator);
+					angle[i] = Uniform_Open(generator);
+				}
+
+				for (size_t i = 0; i < pairCount; i++) {
+					const double r = std::sqrt(-2.0 * std::log(radius[i]));
+					const double theta = 2.0 * std::numbers::pi * angle[i];
+					mValues[i] = r * std::cos(theta);
+					mValues[pairCount + i] = r * std::sin(theta);
+				}
+
+				mNext = 0;
+			}
+
+		public:
+			double Next(std::mt19937& generator) {
+				if (mNext >= Batch_Size) {
+					Refill(generator);
+				}
+				return mValues[mNext++];
+			}
+
+			// the unused variates are a part of the random sequence (needed to resume with identical results)
+			void Save(TBinary_Writer& writer) const {
+				writer.Write<uint64_t>(mNext);
+				writer.Write(mValues);
+			}
+
+			bool Load(TBinary_Reader& reader) {
+				uint64_t next = 0;
+				if (!reader.Read(next) || next > Batch_Size || !reader.Read(mValues)) {
+					return false;
+				}
+				mNext = static_cast<size_t>(next);
+				return true;
+			}
+	};
+}
@@ -0,0 +1,113 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+#include <span>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Appends values to a binary buffer (native endianness, the buffers are not meant to be portable between platforms)
+ */
+class TBinary_Writer {
+	private:
+		std::vector<uint8_t> mBuffer;
+
+	public:
+		void Write_Bytes(const void* data, size_t size) {
+			const auto* bytes = static_cast<const uint8_t*>(data);
+			mBuffer.insert(mBuffer.end(), bytes, bytes + size);
+		}
+
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		void Write(const T& value) {
+			Write_Bytes(&value, sizeof(T));
+		}
+
+		// element count followed by the elements
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		void Write_Span(std::span<const T> values) {
+			Write<uint64_t>(values.size());
+			Write_Bytes(values.data(), values.size_bytes());
+		}
+
+		void Write_String(std::string_view str) {
+			Write<uint64_t>(str.size());
+			Write_Bytes(str.data(), str.size());
+		}
+
+		const std::vector<uint8_t>& Buffer() const {
+			return mBuffer;
+		}
+
+		std::vector<uint8_t> Take() {
+			return std::move(mBuffer);
+		}
+};
+
+/**
+ * Reads values written by TBinary_Writer; all reads fail (return false) once the data are exhausted
+ */
+class TBinary_Reader {
+	private:
+		std::span<const uint8_t> mData;
+		size_t mPosition = 0;
+		bool mFailed = false;
+
+	public:
+		explicit TBinary_Reader(std::span<const uint8_t> data) : mData(data) {}
+
+		bool Read_Bytes(void* target, size_t size) {
+			if (mFailed || size > mData.size() - mPosition) {
+				mFailed = true;
+				return false;
+			}
+			std::memcpy(target, mData.data() + mPosition, size);
+			mPosition += size;
+			return true;
+		}
+
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		bool Read(T& value) {
+			return Read_Bytes(&value, sizeof(T));
+		}
+
+		template<typename T> requires std::is_trivially_copyable_v<T>
+		bool Read_Vector(std::vector<T>& values) {
+			uint64_t count = 0;
+			if (!Read(count) || count > (mData.size() - mPosition) / sizeof(T)) {
+				mFailed = true;
+				return false;
+			}
+			values.resize(static_cast<size_t>(count));
+			return Read_Bytes(values.data(), values.size() * sizeof(T));
+		}
+
+		bool Read_String(std::string& str) {
+			uint64_t size = 0;
+			if (!Read(size) || size > mData.size() - mPosition) {
+				mFailed = true;
+				return false;
+			}
+			str.assign(reinterpret_cast<const char*>(mData.data() + mPosition), static_cast<size_t>(size));
+			mPosition += static_cast<size_t>(size);
+			return true;
+		}
+
+		bool Failed() const {
+			return mFailed;
+		}
+
+		bool At_End() const {
+			return mPosition == mData.size();
+		}
+};
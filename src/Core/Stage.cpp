@@ -28,29 +28,48 @@ bool MenuStage::On_Update(float delta_time) {
 	return true;
 }
 
-bool MenuStage::On_Render() {
-
-	DrawProxy::Text("Optimizers Demo", 10, 10, DARKGRAY, NAppFont::Title);
-	DrawProxy::Text("Select experiment", 10, 40, DARKGRAY, NAppFont::Subtitle);
+namespace {
+	constexpr int Experiments_Per_Row = 4;
+	constexpr int Tile_Height = 60;
+
+	void Draw_Tile(int index, const std::string& name, int x, int y, int width, Color col, Color textColor) {
+		DrawRectangle(x, y, width, Tile_Height, col);
+		TText_Buffer label;
+		label << (index + 1) << ": " << name;
+		DrawProxy::Text(label.View(), x + 5, y + 7, textColor, NAppFont::RegularText);
+	}
+}
 
-	const int experimentsPerRow = 4;
+bool MenuStage::On_Render() {
 
 	auto r = GetScreenWidth();
-	const int rectWidth = r / experimentsPerRow - 10;
-	const int rectHeight = 60;
+	const int rectWidth = r / Experiments_Per_Row - 10;
+
+	// the experiment list does not change, the layer is re-rasterized only when the screen size changes
+	mTiles_Layer.Update(0, [r, rectWidth]() {
+		DrawProxy::Text("Optimizers Demo", 10, 10, DARKGRAY, NAppFont::Title);
+		DrawProxy::Text("Select experiment", 10, 40, DARKGRAY, NAppFont::Subtitle);
+
+		int i = 0;
+		for (auto& exp : ExperimentFactories) {
+			const int x = 10 + (i % Experiments_Per_Row) * ((r - 10) / Experiments_Per_Row);
+			const int y = 80 + (i / Experiments_Per_Row) * (Tile_Height + 10);
+			Draw_Tile(i, exp.second.name, x, y, rectWidth, LIGHTGRAY, DARKGRAY);
+			i++;
+		}
+	});
+	mTiles_Layer.Draw();
 
 	bool mouseOverAny = false;
 
 	int i = 0;
 	for (auto& exp : ExperimentFactories) {
-		const int x = 10 + (i % experimentsPerRow) * ((r - 10) / experimentsPerRow);
-		const int y = 80 + (i / experimentsPerRow) * (rectHeight + 10);
-
-		Color col = LIGHTGRAY;
-		Color textColor = DARKGRAY;
-		if (CheckCollisionPointRec(GetMousePosition(), { (float)x, (float)y, (float)rectWidth, (float)rectHeight })) {
-			col = DARKGREEN;
-			textColor = RAYWHITE;
+		const int x = 10 + (i % Experiments_Per_Row) * ((r - 10) / Experiments_Per_Row);
+		const int y = 80 + (i / Experiments_Per_Row) * (Tile_Height + 10);
+
+		// only the hovered tile is drawn over the layer
+		if (CheckCollisionPointRec(GetMousePosition(), { (float)x, (float)y, (float)rectWidth, (float)Tile_Height })) {
+			Draw_Tile(i, exp.second.name, x, y, rectWidth, DARKGREEN, RAYWHITE);
 			mouseOverAny = true;
 			if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) {
 				Application::Instance().Request_Experiment(exp.first);
@@ -59,9 +78,6 @@ bool MenuStage::On_Render() {
 			}
 		}
 
-		DrawRectangle(x, y, rectWidth, rectHeight, col);
-		DrawProxy::Text(std::to_string(i + 1) + ": " + exp.second.name, x + 5, y + 7, textColor, NAppFont::RegularText);
-
 		i++;
 	}
 
@@ -84,6 +100,8 @@ bool ExperimentStage::On_Enter() {
 
 	if (mExperiment) {
 		mExperiment->On_Init();
+		// one checkpoint per experiment type, so a run can be resumed after the stage was left
+		mExperiment->Set_Checkpoint_Path("checkpoint_" + std::to_string(static_cast<int>(mExperimentType)) + ".ovcp");
 	}
 	else {
 		// Failed to create experiment, return to menu
@@ -11,6 +11,7 @@
 #include <memory>
 
 #include "Experiment.h"
+#include "RenderLayer.h"
 
 // available stages
 enum class NStage {
@@ -42,6 +43,10 @@ class Stage {
  * Menu stage
  */
 class MenuStage : public Stage {
+	private:
+		// retained layer with the headings and the tiles in their idle state
+		TRender_Layer mTiles_Layer;
+
 	public:
 		MenuStage() = default;
 		bool On_Enter() override;
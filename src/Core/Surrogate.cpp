@@ -0,0 +1,255 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "Surrogate.h"
+
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// samples closer than this (in the unit box) are considered duplicates, they would make the system singular
+	constexpr double Duplicate_Distance = 1e-9;
+
+	// the fitted values are clipped to this quantile, so penalty outliers do not make the model oscillate
+	constexpr double Clip_Quantile = 0.75;
+
+	// relative pivot magnitude below which the system is considered singular
+	constexpr double Singular_Pivot = 1e-12;
+
+	double Quantile(std::vector<double> values, double q) {
+		const size_t idx = static_cast<size_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(values.size() - 1));
+		std::nth_element(values.begin(), values.begin() + idx, values.end());
+		return values[idx];
+	}
+
+	double Cubic_Kernel(const std::vector<double>& a, const std::vector<double>& b) {
+		double dist2 = 0.0;
+		for (size_t k = 0; k < a.size(); k++) {
+			dist2 += (a[k] - b[k]) * (a[k] - b[k]);
+		}
+		const double dist = std::sqrt(dist2);
+		return dist * dist * dist;
+	}
+}
+
+TSurrogate_Objective::TSurrogate_Objective(TObjective_Fnc objective, const TOptimizer_Setup& setup, const TSurrogate_Setup& surrogateSetup)
+	: mObjective(std::move(objective)), mData_Revision_Function(setup.dataRevisionFunction), mSetup(surrogateSetup), mLower_Bounds(setup.lowerBounds) {
+
+	if (mData_Revision_Function) {
+		mData_Revision = mData_Revision_Function();
+	}
+
+	mRange.resize(mLower_Bounds.size());
+	for (size_t j = 0; j < mRange.size(); j++) {
+		const double range = setup.upperBounds[j] - setup.lowerBounds[j];
+		mRange[j] = range > 0.0 ? range : 1.0;
+	}
+
+	// the linear tail needs at least one sample more than it has coefficients
+	mSetup.minSamples = std::max(mSetup.minSamples, mLower_Bounds.size() + 2);
+	mSetup.archiveCapacity = std::max(mSetup.archiveCapacity, mSetup.minSamples);
+	mSamples.reserve(mSetup.archiveCapacity);
+}
+
+TObjective_Fnc TSurrogate_Objective::Wrap(TObjective_Fnc objective, const TOptimizer_Setup& setup, const TSurrogate_Setup& surrogateSetup) {
+	auto surrogate = std::make_shared<TSurrogate_Objective>(std::move(objective), setup, surrogateSetup);
+	return [surrogate](const std::vector<double>& parameters) {
+		return (*surrogate)(parameters);
+	};
+}
+
+std::vector<double> TSurrogate_Objective::Normalize(const std::vector<double>& parameters) const {
+	std::vector<double> point(mRange.size());
+	for (size_t j = 0; j < point.size(); j++) {
+		point[j] = (parameters[j] - mLower_Bounds[j]) / mRange[j];
+	}
+	return point;
+}
+
+double TSurrogate_Objective::Predict(const TModel& model, const std::vector<double>& point) {
+	double value = model.tail[0];
+	for (size_t k = 0; k < point.size(); k++) {
+		value += model.tail[k + 1] * point[k];
+	}
+	for (size_t i = 0; i < model.centers.size(); i++) {
+		value += model.weights[i] * Cubic_Kernel(model.centers[i], point);
+	}
+	return value;
+}
+
+std::optional<TSurrogate_Objective::TModel> TSurrogate_Objective::Fit(const std::vector<TSample>& samples) const {
+	const size_t n = samples.size();
+	const size_t d = mRange.size();
+	const size_t m = n + d + 1;
+
+	std::vector<double> values(n);
+	for (size_t i = 0; i < n; i++) {
+		values[i] = samples[i].value;
+	}
+	const double clip = Quantile(values, Clip_Quantile);
+
+	// interpolation system [Phi P; P^T 0] [weights; tail] = [values; 0]
+	std::vector<double> a(m * m, 0.0);
+	std::vector<double> b(m, 0.0);
+	for (size_t i = 0; i < n; i++) {
+		for (size_t j = 0; j < n; j++) {
+			a[i * m + j] = Cubic_Kernel(samples[i].point, samples[j].point);
+		}
+		a[i * m + n] = 1.0;
+		a[n * m + i] = 1.0;
+		for (size_t k = 0; k < d; k++) {
+			a[i * m + n + 1 + k] = samples[i].point[k];
+			a[(n + 1 + k) * m + i] = samples[i].point[k];
+		}
+		b[i] = std::min(samples[i].value, clip);
+	}
+
+	double scale = 0.0;
+	for (const double v : a) {
+		scale = std::max(scale, std::abs(v));
+	}
+
+	// Gaussian elimination with partial pivoting (the system is symmetric, but indefinite)
+	for (size_t col = 0; col < m; col++) {
+		size_t pivot = col;
+		for (size_t row = col + 1; row < m; row++) {
+			if (std::abs(a[row * m + col]) > std::abs(a[pivot * m + col])) {
+				pivot = row;
+			}
+		}
+		if (std::abs(a[pivot * m + col]) <= Singular_Pivot * scale) {
+			return std::nullopt;
+		}
+		if (pivot != col) {
+			std::swap_ranges(a.begin() + col * m, a.begin() + (col + 1) * m, a.begin() + pivot * m);
+			std::swap(b[col], b[pivot]);
+		}
+
+		for (size_t row = col + 1; row < m; row++) {
+			const double factor = a[row * m + col] / a[col * m + col];
+			if (factor == 0.0) {
+				continue;
+			}
+			for (size_t k = col; k < m; k++) {
+				a[row * m + k] -= factor * a[col * m + k];
+			}
+			b[row] -= factor * b[col];
+		}
+	}
+	for (size_t col = m; col-- > 0;) {
+		double sum = b[col];
+		for (size_t k = col + 1; k < m; k++) {
+			sum -= a[col * m + k] * b[k];
+		}
+		b[col] = sum / a[col * m + col];
+	}
+
+	TModel model;
+	model.centers.reserve(n);
+	for (const auto& sample : samples) {
+		model.centers.push_back(sample.point);
+	}
+	model.weights.assign(b.begin(), b.begin() + n);
+	model.tail.assign(b.begin() + n, b.end());
+	model.threshold = Quantile(std::move(values), mSetup.screeningQuantile);
+
+	return model;
+}
+
+void TSurrogate_Objective::Sync_Data_Revision(uint64_t revision) {
+	{
+		std::shared_lock<std::shared_mutex> lock(mMutex);
+		if (revision <= mData_Revision) {
+			return;
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(mMutex);
+	if (revision <= mData_Revision) {
+		return;
+	}
+	mData_Revision = revision;
+	mSamples.clear();
+	mNext_Slot = 0;
+	mPending = 0;
+	mModel.reset();
+}
+
+void TSurrogate_Objective::Add_Sample(std::vector<double>&& point, double value, uint64_t revision) {
+	std::vector<TSample> snapshot;
+	{
+		std::unique_lock<std::shared_mutex> lock(mMutex);
+
+		// evaluated on the old data
+		if (revision != mData_Revision) {
+			return;
+		}
+
+		for (const auto& sample : mSamples) {
+			double dist2 = 0.0;
+			for (size_t k = 0; k < point.size(); k++) {
+				dist2 += (sample.point[k] - point[k]) * (sample.point[k] - point[k]);
+			}
+			if (dist2 < Duplicate_Distance * Duplicate_Distance) {
+				return;
+			}
+		}
+
+		if (mSamples.size() < mSetup.archiveCapacity) {
+			mSamples.push_back({ std::move(point), value });
+		}
+		else {
+			mSamples[mNext_Slot] = { std::move(point), value };
+			mNext_Slot = (mNext_Slot + 1) % mSamples.size();
+		}
+		mPending++;
+
+		// a single thread refits at a time, the others keep screening with the previous model
+		if (mRefitting || mSamples.size() < mSetup.minSamples || mPending < mSetup.refitInterval) {
+			return;
+		}
+		mRefitting = true;
+		mPending = 0;
+		snapshot = mSamples;
+	}
+
+	auto model = Fit(snapshot);
+
+	std::unique_lock<std::shared_mutex> lock(mMutex);
+	// the archive may have been discarded meanwhile (data changed)
+	if (model && revision == mData_Revision) {
+		mModel = std::move(model);
+	}
+	mRefitting = false;
+}
+
+double TSurrogate_Objective::operator()(const std::vector<double>& parameters) {
+	auto point = Normalize(parameters);
+
+	// read before the evaluation, so the sample is never tagged with a newer revision than the data it was evaluated on
+	const uint64_t revision = mData_Revision_Function ? mData_Revision_Function() : 0;
+	Sync_Data_Revision(revision);
+
+	{
+		std::shared_lock<std::shared_mutex> lock(mMutex);
+		if (mModel && revision == mData_Revision) {
+			const double predicted = Predict(*mModel, point);
+			if (predicted > mModel->threshold) {
+				const size_t rejected = mRejected.fetch_add(1, std::memory_order_relaxed) + 1;
+				if (mSetup.explorationInterval == 0 || rejected % mSetup.explorationInterval != 0) {
+					return predicted;
+				}
+			}
+		}
+	}
+
+	const double value = mObjective(parameters);
+	Add_Sample(std::move(point), value, revision);
+	return value;
+}
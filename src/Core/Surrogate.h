@@ -0,0 +1,88 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <shared_mutex>
+#include <atomic>
+#include <cstddef>
+
+#include "Optimizer.h"
+
+/**
+ * Setup of the surrogate pre-screening (see TSurrogate_Objective)
+ */
+struct TSurrogate_Setup {
+	bool enabled = false;
+	size_t archiveCapacity = 256; // evaluated samples the model is fitted over (the oldest are replaced); the refit cost grows cubically
+	size_t minSamples = 32; // samples needed before the screening starts
+	size_t refitInterval = 16; // new samples between model refits
+	double screeningQuantile = 0.5; // candidates predicted worse than this quantile of the archived values are not evaluated
+	size_t explorationInterval = 8; // every N-th rejected candidate is evaluated anyway, so the model learns from its mistakes; 0 = never
+};
+
+/**
+ * Surrogate-assisted objective function for expensive experiments; keeps an archive of the evaluated samples,
+ * fits a cubic radial basis function model (with a linear tail) over them, and evaluates only the candidates
+ * the model considers promising - the rest get the predicted value
+ * The wrapped objective must be deterministic; the wrapper is thread-safe if the wrapped objective is
+ * The archive and the model are discarded when the data revision (TOptimizer_Setup::dataRevisionFunction) moves
+ */
+class TSurrogate_Objective {
+	private:
+		struct TSample {
+			std::vector<double> point; // normalized to the unit box
+			double value;
+		};
+
+		struct TModel {
+			std::vector<std::vector<double>> centers;
+			std::vector<double> weights;
+			std::vector<double> tail; // constant term, then the linear terms
+			double threshold; // predictions above this are rejected
+		};
+
+		TObjective_Fnc mObjective;
+		TData_Revision_Fnc mData_Revision_Function;
+		TSurrogate_Setup mSetup;
+
+		std::vector<double> mLower_Bounds;
+		std::vector<double> mRange;
+
+		// guards the archive and the model; predictions take the shared lock
+		std::shared_mutex mMutex;
+		// data revision the archived samples were evaluated on
+		uint64_t mData_Revision = 0;
+		std::vector<TSample> mSamples;
+		// archive slot to be replaced next (once the archive is full)
+		size_t mNext_Slot = 0;
+		// samples added since the last refit
+		size_t mPending = 0;
+		bool mRefitting = false;
+		std::optional<TModel> mModel;
+
+		std::atomic<size_t> mRejected{ 0 };
+
+		std::vector<double> Normalize(const std::vector<double>& parameters) const;
+		static double Predict(const TModel& model, const std::vector<double>& point);
+		// returns nothing if the interpolation system is singular
+		std::optional<TModel> Fit(const std::vector<TSample>& samples) const;
+		// discards the archive and the model if the data changed (revisions only grow)
+		void Sync_Data_Revision(uint64_t revision);
+		// archives the sample (unless the data changed since it was evaluated) and refits the model when due
+		void Add_Sample(std::vector<double>&& point, double value, uint64_t revision);
+
+	public:
+		TSurrogate_Objective(TObjective_Fnc objective, const TOptimizer_Setup& setup, const TSurrogate_Setup& surrogateSetup);
+
+		double operator()(const std::vector<double>& parameters);
+
+		// wrap the objective function (the setup must have the bounds and the data revision function filled already)
+		static TObjective_Fnc Wrap(TObjective_Fnc objective, const TOptimizer_Setup& setup, const TSurrogate_Setup& surrogateSetup);
+};
@@ -0,0 +1,138 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "ThreadPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+
+namespace {
+	// set in the pool threads, so the nested Parallel_For calls run inline instead of deadlocking
+	thread_local bool gIs_Pool_Thread = false;
+
+	// chunks per thread - a bit of slack for load balancing, as the evaluation cost differs between candidates
+	constexpr size_t Chunks_Per_Thread = 4;
+
+	size_t Worker_Count() {
+#ifdef OPTDEMO_PTHREAD_POOL_SIZE
+		// keep a thread of the pre-spawned pool for the optimization worker and one spare for the runtime
+		const size_t limit = OPTDEMO_PTHREAD_POOL_SIZE > 2 ? OPTDEMO_PTHREAD_POOL_SIZE - 2 : 0;
+#else
+		const size_t limit = 64;
+#endif
+		const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+		// the calling thread participates too
+		return std::min(limit, hardware - 1);
+	}
+}
+
+ThreadPool::ThreadPool() {
+	const size_t count = Worker_Count();
+	for (size_t i = 0; i < count; i++) {
+		mWorkers.emplace_back([this](std::stop_token stopToken) {
+			Worker_Run(stopToken);
+		});
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	for (auto& worker : mWorkers) {
+		worker.request_stop();
+	}
+	mJob_Cv.notify_all();
+	mWorkers.clear();
+}
+
+void ThreadPool::Process_Chunks() {
+	while (true) {
+		const size_t begin = mJob_Next.fetch_add(mJob_Chunk, std::memory_order_relaxed);
+		if (begin >= mJob_Count) {
+			break;
+		}
+		const size_t end = std::min(mJob_Count, begin + mJob_Chunk);
+
+		try {
+			(*mJob_Fnc)(begin, end);
+		}
+		catch (...) {
+			std::lock_guard<std::mutex> lock(mJob_Mutex);
+			if (!mJob_Exception) {
+				mJob_Exception = std::current_exception();
+			}
+			// skip the rest of the job
+			mJob_Next.store(mJob_Count, std::memory_order_relaxed);
+		}
+	}
+}
+
+void ThreadPool::Worker_Run(std::stop_token stopToken) {
+	gIs_Pool_Thread = true;
+
+	uint64_t seenGeneration = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(mJob_Mutex);
+			if (!mJob_Cv.wait(lock, stopToken, [&]() { return mJob_Generation != seenGeneration; })) {
+				return;
+			}
+			seenGeneration = mJob_Generation;
+		}
+
+		{
+			TRACE_SCOPE("ThreadPool::Chunks");
+			Process_Chunks();
+		}
+
+		std::lock_guard<std::mutex> lock(mJob_Mutex);
+		if (--mJob_Active_Workers == 0) {
+			mDone_Cv.notify_all();
+		}
+	}
+}
+
+void ThreadPool::Parallel_For(size_t count, const TRange_Fnc& fnc) {
+	if (count == 0) {
+		return;
+	}
+
+	// nothing to parallelize, or called from within a job
+	if (mWorkers.empty() || count == 1 || gIs_Pool_Thread) {
+		fnc(0, count);
+		return;
+	}
+
+	std::lock_guard<std::mutex> submitLock(mSubmit_Mutex);
+
+	{
+		std::lock_guard<std::mutex> lock(mJob_Mutex);
+		mJob_Fnc = &fnc;
+		mJob_Count = count;
+		mJob_Chunk = std::max<size_t>(1, count / (Concurrency() * Chunks_Per_Thread));
+		mJob_Next.store(0, std::memory_order_relaxed);
+		mJob_Exception = nullptr;
+		mJob_Active_Workers = mWorkers.size();
+		mJob_Generation++;
+	}
+	mJob_Cv.notify_all();
+
+	// the calling thread works too (as a pool thread, so the nested calls run inline)
+	gIs_Pool_Thread = true;
+	Process_Chunks();
+	gIs_Pool_Thread = false;
+
+	std::exception_ptr exception;
+	{
+		std::unique_lock<std::mutex> lock(mJob_Mutex);
+		mDone_Cv.wait(lock, [this]() { return mJob_Active_Workers == 0; });
+		mJob_Fnc = nullptr;
+		exception = mJob_Exception;
+	}
+
+	if (exception) {
+		std::rethrow_exception(exception);
+	}
+}
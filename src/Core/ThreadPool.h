@@ -0,0 +1,70 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+
+#include "ObjectAccessor.h"
+
+using TRange_Fnc = std::function<void(size_t begin, size_t end)>;
+
+/**
+ * Pool of worker threads for data-parallel work (e.g., evaluation of the whole population)
+ * The workers are started when the pool is first accessed; in the web build, the threads are taken from the
+ * pre-spawned Emscripten pthread pool, so the pool must be first accessed from the main thread
+ */
+class ThreadPool : public IObject {
+	private:
+		std::vector<std::jthread> mWorkers;
+
+		// serializes Parallel_For calls from different threads
+		std::mutex mSubmit_Mutex;
+
+		std::mutex mJob_Mutex;
+		std::condition_variable_any mJob_Cv;
+		std::condition_variable mDone_Cv;
+
+		// current job
+		const TRange_Fnc* mJob_Fnc = nullptr;
+		size_t mJob_Count = 0;
+		size_t mJob_Chunk = 1;
+		std::atomic<size_t> mJob_Next{ 0 };
+		// incremented for every job, so the workers know there is a new one
+		uint64_t mJob_Generation = 0;
+		// number of workers still working on the current job
+		size_t mJob_Active_Workers = 0;
+
+		std::exception_ptr mJob_Exception;
+
+		void Worker_Run(std::stop_token stopToken);
+		// processes chunks of the current job until there are none left
+		void Process_Chunks();
+
+	public:
+		ThreadPool();
+		~ThreadPool() override;
+
+		static ThreadPool& Instance() {
+			return CObjectAccessor::get<ThreadPool>();
+		}
+
+		// number of threads working on a job (workers and the calling thread)
+		size_t Concurrency() const {
+			return mWorkers.size() + 1;
+		}
+
+		// calls fnc for disjoint ranges covering [0, count) in parallel, the calling thread participates;
+		// blocks until all the ranges are processed, rethrows the first exception thrown by fnc
+		void Parallel_For(size_t count, const TRange_Fnc& fnc);
+};
@@ -1,4 +1,5 @@
 #include "TinyVM.h"
+#include "Trace.h"
 
 namespace TinyVM {
 	Machine::Machine(const MachineFeatures& features)
@@ -56,6 +57,8 @@ namespace TinyVM {
 
 	// memory = constants + instructions
 	std::vector<double> Machine::Run(const std::vector<double>& input, const std::vector<double>& memory) {
+		TRACE_SCOPE("TinyVM::Machine::Run");
+
 
 		std::vector<double> outputs;
 		outputs.resize(mFeatures.outputCount, 0.0);
@@ -0,0 +1,88 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "Trace.h"
+
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+
+namespace {
+	const auto Trace_Epoch = std::chrono::steady_clock::now();
+}
+
+uint64_t Tracer::Now_Ns() {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Trace_Epoch).count());
+}
+
+Tracer::TThread_Buffer& Tracer::Local_Buffer() {
+	thread_local std::shared_ptr<TThread_Buffer> buffer = []() {
+		auto buf = std::make_shared<TThread_Buffer>();
+		std::lock_guard<std::mutex> lock(mRegistry_Mutex);
+		buf->threadId = static_cast<uint32_t>(mRegistry.size() + 1);
+		mRegistry.push_back(buf);
+		return buf;
+	}();
+
+	return *buffer;
+}
+
+void Tracer::Record(const char* name, uint64_t startNs, uint64_t durationNs) {
+	auto& buffer = Local_Buffer();
+
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	buffer.events[buffer.head % Ring_Capacity] = { name, startNs, durationNs };
+	buffer.head++;
+}
+
+bool Tracer::Dump_Chrome_Trace(const std::string& path) {
+	std::ofstream out(path);
+	if (!out.is_open()) {
+		return false;
+	}
+
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	std::vector<TTrace_Event> events;
+
+	std::lock_guard<std::mutex> lock(mRegistry_Mutex);
+	for (const auto& buffer : mRegistry) {
+		// the events are copied out, so the recording thread is blocked only for the copy (not for the file output)
+		{
+			std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+			const uint64_t begin = buffer->head > Ring_Capacity ? buffer->head - Ring_Capacity : 0;
+
+			events.clear();
+			for (uint64_t i = begin; i < buffer->head; i++) {
+				events.push_back(buffer->events[i % Ring_Capacity]);
+			}
+		}
+
+		for (const auto& evt : events) {
+			if (!evt.name) {
+				continue;
+			}
+
+			if (!first) {
+				out << ',';
+			}
+			first = false;
+
+			// timestamps are in microseconds
+			out << "{\"name\":\"" << evt.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"ts\":" << (static_cast<double>(evt.startNs) / 1000.0)
+				<< ",\"dur\":" << (static_cast<double>(evt.durationNs) / 1000.0) << '}';
+		}
+	}
+
+	out << "]}";
+
+	return out.good();
+}
@@ -0,0 +1,83 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// scoped trace events are compiled in only when OPTDEMO_TRACING is defined (CMake option OPTDEMO_ENABLE_TRACING)
+#ifdef OPTDEMO_TRACING
+	#define TRACE_CONCAT_INNER(a, b) a##b
+	#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+	// name must be a string literal (only the pointer is stored)
+	#define TRACE_SCOPE(name) TTrace_Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#else
+	#define TRACE_SCOPE(name) ((void)0)
+#endif
+
+// single complete trace event
+struct TTrace_Event {
+	const char* name = nullptr;
+	uint64_t startNs = 0;
+	uint64_t durationNs = 0;
+};
+
+/**
+ * Tracer with thread-local ring buffers; the oldest events are overwritten
+ * Recording only takes the lock of the thread's own buffer, which is contended just while the events are being dumped
+ */
+class Tracer {
+	public:
+		// events kept per thread
+		static constexpr size_t Ring_Capacity = 1 << 15;
+
+	private:
+		struct TThread_Buffer {
+			uint32_t threadId = 0;
+			// guards head and events (the owning thread records, the dump reads)
+			std::mutex mutex;
+			uint64_t head = 0;
+			std::array<TTrace_Event, Ring_Capacity> events;
+		};
+
+		// buffers are kept alive after their thread exits, so their events can still be dumped
+		inline static std::mutex mRegistry_Mutex;
+		inline static std::vector<std::shared_ptr<TThread_Buffer>> mRegistry;
+
+		static TThread_Buffer& Local_Buffer();
+
+	public:
+		// monotonic time in nanoseconds
+		static uint64_t Now_Ns();
+
+		// record a complete event into the calling thread's ring buffer
+		static void Record(const char* name, uint64_t startNs, uint64_t durationNs);
+
+		// write all buffered events in Chrome trace (JSON) format, which is readable by chrome://tracing and Perfetto
+		static bool Dump_Chrome_Trace(const std::string& path);
+};
+
+/**
+ * RAII scope recording a single trace event
+ */
+class TTrace_Scope {
+	private:
+		const char* mName;
+		uint64_t mStart;
+
+	public:
+		TTrace_Scope(const char* name) : mName(name), mStart(Tracer::Now_Ns()) {}
+
+		~TTrace_Scope() {
+			Tracer::Record(mName, mStart, Tracer::Now_Ns() - mStart);
+		}
+};
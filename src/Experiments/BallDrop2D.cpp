@@ -10,25 +10,149 @@
 #include "../Core/DrawProxy.h"
 #include "../Core/Optimizer.h"
 #include "../Core/Helpers.h"
+#include "../Core/Surrogate.h"
 
 #include "../Optimizers/GeneticAlgorithm.h"
 
 #include "../Core/PhysicsWrapper.h"
 
 #include <numbers>
+#include <cmath>
+
+namespace {
+	// simulation length at full fidelity (the coarse simulation covers the same time)
+	constexpr size_t Full_Fidelity_Max_Steps = 1000;
+
+	constexpr float Gravity = 9.81f;
+	constexpr float Ball_Start_Y = 50.0f;
+	constexpr float Ball_Radius = 5.0f;
+	constexpr float Obstacle_Size = 40.0f;
+
+	// the physics creates contacts a bit before the shapes touch (speculative contacts); the pre-screen leaves
+	// the candidates passing this close to a body to the physics
+	constexpr float Contact_Margin = 3.0f;
+
+	// we don't require exact euclidean distance, so we can use Manhattan distance for speed
+	float Manhattan_Distance(const Vector2& a, const Vector2& b) {
+		return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+	}
+
+	// obstacles too close to the screen edges are left out of the simulation
+	bool Is_Simulated_Obstacle(const Vector2& obstacle) {
+		return obstacle.x >= 20 && obstacle.x <= GetScreenWidth() - 20 && obstacle.y >= 20 && obstacle.y <= GetScreenHeight() - 20;
+	}
+
+	// slab test of a segment against an axis-aligned rectangle
+	bool Segment_Intersects_Rect(Vector2 from, Vector2 to, const Rectangle& rect) {
+		double tMin = 0.0;
+		double tMax = 1.0;
+
+		const double origin[2] = { from.x, from.y };
+		const double delta[2] = { to.x - from.x, to.y - from.y };
+		const double lo[2] = { rect.x, rect.y };
+		const double hi[2] = { rect.x + rect.width, rect.y + rect.height };
+
+		for (int axis = 0; axis < 2; axis++) {
+			if (delta[axis] == 0.0) {
+				if (origin[axis] < lo[axis] || origin[axis] > hi[axis]) {
+					return false;
+				}
+				continue;
+			}
+
+			double t0 = (lo[axis] - origin[axis]) / delta[axis];
+			double t1 = (hi[axis] - origin[axis]) / delta[axis];
+			if (t0 > t1) {
+				std::swap(t0, t1);
+			}
+			tMin = std::max(tMin, t0);
+			tMax = std::min(tMax, t1);
+			if (tMin > tMax) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+void TObstacle_Grid::Cell_Range(Vector2 min, Vector2 max, int& c0, int& r0, int& c1, int& r1) const {
+	// anything reaching out of the screen is clamped to the border cells
+	c0 = std::clamp(static_cast<int>(std::floor(min.x / Cell_Size)), 0, columns - 1);
+	c1 = std::clamp(static_cast<int>(std::floor(max.x / Cell_Size)), 0, columns - 1);
+	r0 = std::clamp(static_cast<int>(std::floor(min.y / Cell_Size)), 0, rows - 1);
+	r1 = std::clamp(static_cast<int>(std::floor(max.y / Cell_Size)), 0, rows - 1);
+}
+
+void TObstacle_Grid::Build(const std::vector<Rectangle>& obstacles, float width, float height, float inflation) {
+	columns = std::max(1, static_cast<int>(std::ceil(width / Cell_Size)));
+	rows = std::max(1, static_cast<int>(std::ceil(height / Cell_Size)));
+
+	boxes.clear();
+	for (const auto& obstacle : obstacles) {
+		boxes.push_back({ obstacle.x - inflation, obstacle.y - inflation, obstacle.width + 2.0f * inflation, obstacle.height + 2.0f * inflation });
+	}
+
+	auto forEachCell = [this](const Rectangle& box, auto&& fnc) {
+		int c0, r0, c1, r1;
+		Cell_Range({ box.x, box.y }, { box.x + box.width, box.y + box.height }, c0, r0, c1, r1);
+		for (int r = r0; r <= r1; r++) {
+			for (int c = c0; c <= c1; c++) {
+				fnc(static_cast<size_t>(r * columns + c));
+			}
+		}
+	};
+
+	// count the boxes per cell, then fill the compacted lists
+	cellStart.assign(static_cast<size_t>(columns * rows) + 1, 0);
+	for (const auto& box : boxes) {
+		forEachCell(box, [this](size_t cell) {
+			cellStart[cell + 1]++;
+		});
+	}
+	for (size_t c = 1; c < cellStart.size(); c++) {
+		cellStart[c] += cellStart[c - 1];
+	}
+
+	cellItems.resize(cellStart.back());
+	std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+	for (uint32_t i = 0; i < boxes.size(); i++) {
+		forEachCell(boxes[i], [this, &fill, i](size_t cell) {
+			cellItems[fill[cell]++] = i;
+		});
+	}
+}
+
+bool TObstacle_Grid::Segment_Hits(Vector2 from, Vector2 to) const {
+	int c0, r0, c1, r1;
+	Cell_Range({ std::min(from.x, to.x), std::min(from.y, to.y) }, { std::max(from.x, to.x), std::max(from.y, to.y) }, c0, r0, c1, r1);
+
+	for (int r = r0; r <= r1; r++) {
+		for (int c = c0; c <= c1; c++) {
+			const size_t cell = static_cast<size_t>(r * columns + c);
+			for (uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; k++) {
+				if (Segment_Intersects_Rect(from, to, boxes[cellItems[k]])) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
 
 bool BallDrop2D::On_Init() {
 	mObstacles.clear();
+	mObstacles_Revision++;
+	Update_Obstacle_Scene();
 	mName = "Ball drop 2D";
 	mDescription = "Dropping the ball into a target area as fast as possible";
 	return true;
 }
 
 bool BallDrop2D::On_Cleanup() {
+	Stop_Optimization();
 	mObstacles.clear();
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
-	}
+	mObstacles_Revision++;
+	Update_Obstacle_Scene();
 	return true;
 }
 
@@ -39,12 +163,32 @@ bool BallDrop2D::On_Update(float delta_time) {
 void BallDrop2D::Reset_Data() {
 	Experiment::Reset_Data();
 	mObstacles.clear();
+	mObstacles_Revision++;
+	Update_Obstacle_Scene();
+
+	std::lock_guard<std::mutex> lock(mBest_Positions_Mutex);
+	mBest_Positions.clear();
+	mBest_Positions_Candidate.clear();
+}
+
+void BallDrop2D::Save_Checkpoint_Data(TBinary_Writer& writer) const {
+	writer.Write_Span<Vector2>(mObstacles);
+}
+
+bool BallDrop2D::Load_Checkpoint_Data(TBinary_Reader& reader) {
+	if (!reader.Read_Vector(mObstacles)) {
+		return false;
+	}
+	mObstacles_Revision++;
+	Update_Obstacle_Scene();
+	return true;
 }
 
 bool BallDrop2D::On_Render() {
 
 	if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !Is_Mouse_In_UI_Area()) {
 		mObstacles.push_back(GetMousePosition());
+		mObstacles_Revision++;
 		mDragging_Obstacles = true;
 	}
 
@@ -61,21 +205,28 @@ bool BallDrop2D::On_Render() {
 
 			if (std::abs(pos.x - last.x) > minDist || std::abs(pos.y - last.y) > minDist) {
 				mObstacles.push_back(pos);
+				mObstacles_Revision++;
 			}
 		}
 	}
 
-	DrawCircle(GetScreenWidth() / 2, 50, 5, BEIGE); // starting point
-	DrawRectangle(0, GetScreenHeight() - 10, GetScreenWidth(), 10, DARKGREEN); // target area
+	// the running optimization evaluates the edited scene from now on
+	Update_Obstacle_Scene();
 
-	for (const auto& obstacle : mObstacles) {
-		DrawRectangle(static_cast<int>(obstacle.x) - 20, static_cast<int>(obstacle.y) - 20, 40, 40, RED);
-	}
+	mData_Layer.Update(mObstacles_Revision, [this]() {
+		DrawCircle(GetScreenWidth() / 2, 50, 5, BEIGE); // starting point
+		DrawRectangle(0, GetScreenHeight() - 10, GetScreenWidth(), 10, DARKGREEN); // target area
+
+		for (const auto& obstacle : mObstacles) {
+			DrawRectangle(static_cast<int>(obstacle.x) - 20, static_cast<int>(obstacle.y) - 20, 40, 40, RED);
+		}
+	});
+	mData_Layer.Draw();
 
 	return Experiment::On_Render();
 }
 
-void BallDrop2D::Draw_Candidate(const std::vector<double>& candidate, bool best) {
+void BallDrop2D::Draw_Candidate(const std::vector<double>& candidate, bool best, NDraw_Detail detail) {
 	if (candidate.size() == 2) {
 
 		if (best) {
@@ -99,16 +250,22 @@ void BallDrop2D::Draw_Candidate(const std::vector<double>& candidate, bool best)
 void BallDrop2D::Cache_Best_Candidate(double bestMetric, const std::vector<std::vector<double>>& population) {
 	if (!population.empty()) {
 		std::lock_guard<std::mutex> lock(mBest_Positions_Mutex);
+		if (population[0] == mBest_Positions_Candidate) {
+			// the best candidate did not change, the trajectory is still valid
+			return;
+		}
+		mBest_Positions_Candidate = population[0];
 		mBest_Positions.clear();
-		// simulate the best candidate and store the positions
-		PhysicsWorld world({ .gravity = { 0, 9.81f } });
-		world.Add_Dynamic_Ball_Body(GetScreenWidth() / 2.0f, 50.0f, 5.0f, static_cast<float>(population[0][0]), static_cast<float>(population[0][1]));
-		for (const auto& obstacle : mObstacles) {
-			world.Add_Static_Rect_Body(obstacle.x, obstacle.y, 40.0f, 40.0f);
+		// simulate the best candidate (in the scene the optimizer sees) and store the positions
+		const auto scene = Obstacle_Scene();
+		PhysicsWorld world({ .gravity = { 0, Gravity } });
+		world.Add_Dynamic_Ball_Body(GetScreenWidth() / 2.0f, Ball_Start_Y, Ball_Radius, static_cast<float>(population[0][0]), static_cast<float>(population[0][1]));
+		for (const auto& obstacle : scene->obstacles) {
+			world.Add_Static_Rect_Body(obstacle.x, obstacle.y, Obstacle_Size, Obstacle_Size);
 		}
 		// simulate until the ball reaches the bottom of the screen
-		for (size_t i = 0; i < 1000; i++) {
-			world.Step(1.0f / 60.0f);
+		for (size_t i = 0; i < Full_Fidelity_Max_Steps; i++) {
+			world.Step();
 			const auto& positions = world.Get_Ball_Positions();
 			if (!positions.empty() && positions.back().y >= GetScreenHeight()) {
 				// ball reached the bottom of the screen
@@ -127,6 +284,10 @@ bool BallDrop2D::Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPosition
 	return false;
 }
 
+NOptimizer BallDrop2D::Optimizer_Type() const {
+	return NOptimizer::GeneticAlgorithm_SteadyState;
+}
+
 void BallDrop2D::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 	setup.maxIterations = 20000;
 	setup.populationSize = 100;
@@ -135,38 +296,87 @@ void BallDrop2D::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 	setup.upperBounds = { std::numbers::pi, 10.0 };
 	setup.sensitivity = { 0.2, 0.1 };
 	setup.initialGuess = { 0.0, 0.0 };
+
+	// the coarse simulation is several times cheaper, but it only approximates the bounces
+	setup.promotionFraction = 0.1;
+}
+
+void BallDrop2D::Update_Obstacle_Scene() {
+	if (mObstacle_Scene && mObstacle_Scene_Revision == mObstacles_Revision) {
+		return;
+	}
+
+	auto scene = std::make_shared<TObstacle_Scene>();
+
+	std::vector<Rectangle> bodies;
+	for (const auto& rect : PhysicsWorld::Get_Boundary_Rects()) {
+		bodies.push_back(rect);
+	}
+	for (const auto& obstacle : mObstacles) {
+		if (Is_Simulated_Obstacle(obstacle)) {
+			scene->obstacles.push_back(obstacle);
+			bodies.push_back({ obstacle.x - Obstacle_Size / 2.0f, obstacle.y - Obstacle_Size / 2.0f, Obstacle_Size, Obstacle_Size });
+		}
+	}
+	scene->grid.Build(bodies, static_cast<float>(GetScreenWidth()), static_cast<float>(GetScreenHeight()), Ball_Radius + Contact_Margin);
+
+	std::lock_guard<std::mutex> lock(mObstacle_Scene_Mutex);
+	mObstacle_Scene = std::move(scene);
+	mObstacle_Scene_Revision = mObstacles_Revision;
+}
+
+std::shared_ptr<const TObstacle_Scene> BallDrop2D::Obstacle_Scene() {
+	std::lock_guard<std::mutex> lock(mObstacle_Scene_Mutex);
+	return mObstacle_Scene;
+}
+
+void BallDrop2D::Fill_Surrogate_Setup(TSurrogate_Setup& setup) {
+	setup.enabled = true;
 }
 
 double BallDrop2D::Objective_Function(const std::vector<double>& parameters) {
+	return Simulate(parameters, NPhysics_Fidelity::Full);
+}
+
+double BallDrop2D::Objective_Function_Coarse(const std::vector<double>& parameters) {
+	return Simulate(parameters, NPhysics_Fidelity::Coarse);
+}
+
+double BallDrop2D::Simulate(const std::vector<double>& parameters, NPhysics_Fidelity fidelity) {
 	if (parameters.size() != 2) {
 		throw std::invalid_argument("Expected 2 parameters: slope and intercept");
 	}
 
-	// we don't require exact euclidean distance, so we can use Manhattan distance for speed
-	auto calcDistance = [](const Vector2& a, const Vector2& b) {
-		return (std::abs(a.x - b.x) + std::abs(a.y - b.y));
-	};
+	// a coarse step covers multiple full fidelity steps - the simulation length and the per-step penalty are scaled, so the levels are comparable
+	const double stepScale = PhysicsWorld::Get_Time_Step(fidelity) / PhysicsWorld::Get_Time_Step(NPhysics_Fidelity::Full);
+	const size_t maxSteps = static_cast<size_t>(std::lround(Full_Fidelity_Max_Steps / stepScale));
 
-	PhysicsWorld world({ .gravity = { 0, 9.81f } });
+	// the whole evaluation sees the same scene, even if the obstacles are edited meanwhile
+	const auto scene = Obstacle_Scene();
 
-	world.Add_Dynamic_Ball_Body(GetScreenWidth() / 2.0f, 50.0f, 5.0f, static_cast<float>(parameters[0]), static_cast<float>(parameters[1]));
-	for (const auto& obstacle : mObstacles) {
-		if (obstacle.x < 20 || obstacle.x > GetScreenWidth() - 20 || obstacle.y < 20 || obstacle.y > GetScreenHeight() - 20) {
-			continue;
-		}
-		world.Add_Static_Rect_Body(obstacle.x, obstacle.y, 40.0f, 40.0f);
+	// only the candidates touching something pay for the physics engine
+	double objective = 0.0;
+	if (Try_Free_Flight(*scene, parameters, fidelity, maxSteps, stepScale, objective)) {
+		return objective;
+	}
+
+	PhysicsWorld world({ .gravity = { 0, Gravity }, .fidelity = fidelity });
+
+	world.Add_Dynamic_Ball_Body(GetScreenWidth() / 2.0f, Ball_Start_Y, Ball_Radius, static_cast<float>(parameters[0]), static_cast<float>(parameters[1]));
+	for (const auto& obstacle : scene->obstacles) {
+		world.Add_Static_Rect_Body(obstacle.x, obstacle.y, Obstacle_Size, Obstacle_Size);
 	}
 
 	// simulate until the ball reaches the bottom of the screen
-	for (size_t i = 0; i < 1000; i++) {
-		world.Step(1.0f / 60.0f);
+	for (size_t i = 0; i < maxSteps; i++) {
+		world.Step();
 		const auto& positions = world.Get_Ball_Positions();
 		if (!positions.empty() && positions.back().y >= GetScreenHeight()) {
 			// go through the positions, assume they mark a valid trajectory
 			// calculate the distance it needed to travel using the positions
 			double distance = 0.0;
 			for (size_t j = 1; j < positions.size(); j++) {
-				distance += calcDistance(positions[j - 1], positions[j]) + 1.0f; // +1 to prefer shorter paths with fewer bounces (not exactly bulletproof, but works well enough)
+				distance += Manhattan_Distance(positions[j - 1], positions[j]) + stepScale; // +1 per full step to prefer shorter paths with fewer bounces (not exactly bulletproof, but works well enough)
 			}
 			return distance;
 		}
@@ -182,3 +392,48 @@ double BallDrop2D::Objective_Function(const std::vector<double>& parameters) {
 		return 1000000.0;
 	}
 }
+
+bool BallDrop2D::Try_Free_Flight(const TObstacle_Scene& scene, const std::vector<double>& parameters, NPhysics_Fidelity fidelity, size_t maxSteps, double stepScale, double& objective) const {
+	if (scene.grid.Empty()) {
+		return false;
+	}
+
+	// the physics integrates with semi-implicit Euler per substep, so the ball moves along a straight segment within a substep
+	// (the same parabola in closed form would differ from the simulated one by the integration error)
+	const int subSteps = PhysicsWorld::Get_Sub_Steps(fidelity);
+	const float subStep = PhysicsWorld::Get_Time_Step(fidelity) / static_cast<float>(subSteps);
+	const float gravity = Physics_To_Screen_Scale * Gravity;
+	const float screenHeight = static_cast<float>(GetScreenHeight());
+
+	const float direction = static_cast<float>(parameters[0]);
+	const float velocity = static_cast<float>(parameters[1]);
+
+	Vector2 position = { GetScreenWidth() / 2.0f, Ball_Start_Y };
+	Vector2 speed = { Physics_To_Screen_Scale * velocity * cosf(direction), Physics_To_Screen_Scale * velocity * sinf(direction) };
+
+	// mirrors the objective function over the recorded positions (one per step)
+	double distance = 0.0;
+	Vector2 previous = position;
+	for (size_t i = 0; i < maxSteps; i++) {
+		for (int s = 0; s < subSteps; s++) {
+			speed.y += gravity * subStep;
+			const Vector2 next = { position.x + speed.x * subStep, position.y + speed.y * subStep };
+			if (scene.grid.Segment_Hits(position, next)) {
+				return false;
+			}
+			position = next;
+		}
+
+		if (i > 0) {
+			distance += Manhattan_Distance(previous, position) + stepScale;
+		}
+		previous = position;
+
+		if (position.y >= screenHeight) {
+			objective = distance;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -8,22 +8,86 @@
 #pragma once
 
 #include "../Core/Experiment.h"
+#include "../Core/PhysicsWrapper.h"
 
 #include <vector>
 #include <mutex>
+#include <memory>
+#include <atomic>
 #include "raylib.h"
 
+/**
+ * Uniform grid over the screen for the ball trajectory collision checks; the boxes are stored inflated
+ * by the ball radius (and a contact margin), so the ball can be tested as a point
+ */
+struct TObstacle_Grid {
+	static constexpr float Cell_Size = 64.0f;
+
+	int columns = 0;
+	int rows = 0;
+	std::vector<Rectangle> boxes;
+	// boxes overlapping cell c are cellItems[cellStart[c]] .. cellItems[cellStart[c + 1] - 1]
+	std::vector<uint32_t> cellStart;
+	std::vector<uint32_t> cellItems;
+
+	// cells overlapped by the given bounds (inclusive)
+	void Cell_Range(Vector2 min, Vector2 max, int& c0, int& r0, int& c1, int& r1) const;
+
+	void Build(const std::vector<Rectangle>& obstacles, float width, float height, float inflation);
+
+	bool Empty() const {
+		return columns == 0;
+	}
+
+	// does the segment touch any (inflated) box?
+	bool Segment_Hits(Vector2 from, Vector2 to) const;
+};
+
+/**
+ * Immutable snapshot of the scene the objective function simulates; the UI thread edits the obstacles
+ * meanwhile, so the evaluations never read them directly
+ */
+struct TObstacle_Scene {
+	// centers of the simulated obstacles
+	std::vector<Vector2> obstacles;
+	// static bodies of the scene (boundaries and obstacles) for the analytic pre-screen
+	TObstacle_Grid grid;
+};
+
 class BallDrop2D : public Experiment {
 	private:
 		std::vector<Vector2> mObstacles;
+		// incremented on every change of mObstacles (the obstacles layer and the scene are rebuilt then)
+		uint64_t mObstacles_Revision = 0;
 
 		bool mDragging_Obstacles = false;
 
 		std::mutex mBest_Positions_Mutex;
 		std::vector<Vector2> mBest_Positions;
+		// candidate the mBest_Positions were simulated for (to avoid re-simulating the same candidate)
+		std::vector<double> mBest_Positions_Candidate;
+
+		// scene the evaluations simulate; rebuilt by the UI thread whenever the obstacles change (evaluations in progress
+		// keep the scene they started with)
+		std::mutex mObstacle_Scene_Mutex;
+		std::shared_ptr<const TObstacle_Scene> mObstacle_Scene;
+		// mObstacles_Revision the scene was built for (published after the scene, so it is the revision the objective sees)
+		std::atomic<uint64_t> mObstacle_Scene_Revision{ 0 };
+
+		// rebuilds the scene if the obstacles changed; called from the UI thread only
+		void Update_Obstacle_Scene();
+		std::shared_ptr<const TObstacle_Scene> Obstacle_Scene();
+
+		// objective function at the given simulation fidelity
+		double Simulate(const std::vector<double>& parameters, NPhysics_Fidelity fidelity);
+		// follows the ball in free flight the same way the physics integrates it; fills the objective and returns true
+		// if the ball reaches the bottom without touching anything (otherwise the physics has to resolve the contacts)
+		bool Try_Free_Flight(const TObstacle_Scene& scene, const std::vector<double>& parameters, NPhysics_Fidelity fidelity, size_t maxSteps, double stepScale, double& objective) const;
 
 	protected:
 		void Cache_Best_Candidate(double bestMetric, const std::vector<std::vector<double>>& population) override;
+		void Save_Checkpoint_Data(TBinary_Writer& writer) const override;
+		bool Load_Checkpoint_Data(TBinary_Reader& reader) override;
 
 	public:
 		BallDrop2D() = default;
@@ -34,9 +98,17 @@ class BallDrop2D : public Experiment {
 		bool On_Update(float delta_time) override;
 		bool On_Render() override;
 
-		void Draw_Candidate(const std::vector<double>& candidate, bool best = false) override;
+		void Draw_Candidate(const std::vector<double>& candidate, bool best = false, NDraw_Detail detail = NDraw_Detail::Full) override;
 		double Objective_Function(const std::vector<double>& parameters) override;
+		uint64_t Data_Revision() const override { return mObstacle_Scene_Revision; }
+		// most candidates are screened by a coarse simulation, only the promising ones are simulated at full fidelity
+		double Objective_Function_Coarse(const std::vector<double>& parameters) override;
+		bool Has_Coarse_Objective() const override { return true; }
 		void Fill_Optimizer_Setup(TOptimizer_Setup& setup) override;
+		// every evaluation is a full physics simulation, so the hopeless candidates are screened out by the surrogate
+		void Fill_Surrogate_Setup(TSurrogate_Setup& setup) override;
+		// simulations ending early (ball leaving the screen fast) are much cheaper than the long ones
+		NOptimizer Optimizer_Type() const override;
 		bool Check_Can_Optimize() override;
 		void Reset_Data() override;
 		bool Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPositionY) override;
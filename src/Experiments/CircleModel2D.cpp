@@ -10,9 +10,18 @@
 #include "../Core/DrawProxy.h"
 #include "../Core/Optimizer.h"
 #include "../Core/Helpers.h"
+#include "../Core/Kernels.h"
 
 #include "../Optimizers/GeneticAlgorithm.h"
 
+#include <cmath>
+#include <numbers>
+
+namespace {
+	// number of segments of the circle drawn in reduced detail
+	constexpr int Reduced_Circle_Segments = 16;
+}
+
 bool CircleModel2D::On_Init() {
 	mData_Points.clear();
 	mName = "Circle Model 2D";
@@ -21,10 +30,8 @@ bool CircleModel2D::On_Init() {
 }
 
 bool CircleModel2D::On_Cleanup() {
+	Stop_Optimization();
 	mData_Points.clear();
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
-	}
 	return true;
 }
 
@@ -37,38 +44,57 @@ void CircleModel2D::Reset_Data() {
 	mData_Points.clear();
 }
 
+void CircleModel2D::Save_Checkpoint_Data(TBinary_Writer& writer) const {
+	Save_Points(writer, mData_Points);
+}
+
+bool CircleModel2D::Load_Checkpoint_Data(TBinary_Reader& reader) {
+	return Load_Points(reader, mData_Points);
+}
+
 bool CircleModel2D::On_Render() {
 
 	if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !Is_Mouse_In_UI_Area()) {
 		mData_Points.push_back(GetMousePosition());
 	}
 
-	for (const auto& point : mData_Points) {
-		DrawCircleV(point, 3, RED);
-	}
+	mData_Layer.Update(mData_Points.Revision(), [this]() {
+		mData_Cloud.Sync(mData_Points, RED);
+		mData_Cloud.Draw(3.0f);
+	});
+	mData_Layer.Draw();
 
 	// draw candidates
-	if (mCandidates.size() > 0) {
-
-		std::unique_lock<std::mutex> lock(mCandidates_Mutex, std::defer_lock);
-		if (mIs_Optimizing) {
-			lock.lock();
-		}
-
-		DrawProxy::Text("C[" + std::to_string(mCandidates[0][0]) + "; " + std::to_string(mCandidates[0][1]) + "], r = " + std::to_string(mCandidates[0][2]), 10, GetScreenHeight() - 50, DARKGRAY, NAppFont::RegularText);
+	Refresh_Render_Candidates();
+	if (mRender_Candidates.size() > 0) {
+		TText_Buffer circle;
+		circle << "C[" << mRender_Candidates[0][0] << "; " << mRender_Candidates[0][1] << "], r = " << mRender_Candidates[0][2];
+		DrawProxy::Text_Uncached(circle.c_str(), 10, GetScreenHeight() - 50, DARKGRAY, NAppFont::RegularText);
 	}
 
 	return Experiment::On_Render();
 }
 
-void CircleModel2D::Draw_Candidate(const std::vector<double>& candidate, bool best) {
+void CircleModel2D::Draw_Candidate(const std::vector<double>& candidate, bool best, NDraw_Detail detail) {
 	if (candidate.size() == 3) {
 		double x = candidate[0];
 		double y = candidate[1];
 		double radius = candidate[2];
 
 		Color col = best ? BLUE : LIGHTGRAY;
-		DrawCircleLines((int)x, (int)y, (float)radius, col);
+		if (detail == NDraw_Detail::Reduced) {
+			// coarse polygon in the line batch
+			Vector2 prev = { static_cast<float>(x + radius), static_cast<float>(y) };
+			for (int i = 1; i <= Reduced_Circle_Segments; i++) {
+				const double angle = (2.0 * std::numbers::pi * i) / Reduced_Circle_Segments;
+				const Vector2 cur = { static_cast<float>(x + radius * std::cos(angle)), static_cast<float>(y + radius * std::sin(angle)) };
+				mLine_Batch.Add(prev, cur, col);
+				prev = cur;
+			}
+		}
+		else {
+			DrawCircleLines((int)x, (int)y, (float)radius, col);
+		}
 	}
 }
 
@@ -85,6 +111,12 @@ bool CircleModel2D::Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPosit
 	return false;
 }
 
+bool CircleModel2D::Load_Dataset(const TDataset& dataset) {
+	// dataset points are expected in screen coordinates
+	dataset.View_All(mData_Points);
+	return true;
+}
+
 void CircleModel2D::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 	setup.maxIterations = 80000;
 	setup.populationSize = 50;
@@ -104,13 +136,39 @@ double CircleModel2D::Objective_Function(const std::vector<double>& parameters)
 	const double centerX = parameters[0];
 	const double centerY = parameters[1];
 	const double radius = parameters[2];
+	if (mSubset_Indices.empty()) {
+		return Kernels::Sum_Squared_Circle_Residuals(mData_Points.Points(), centerX, centerY, radius) / mData_Points.size();
+	}
 	double totalError = 0.0;
-	for (const auto& point : mData_Points) {
+	For_Each_Sample(mData_Points.Points(), [&](const Vector2& point) {
 		const double dx = point.x - centerX;
 		const double dy = point.y - centerY;
 		const double dist = std::sqrt(dx * dx + dy * dy);
 		const double error = dist - radius;
 		totalError += error * error; // squared error
+	});
+	return totalError / Sample_Count(mData_Points.size());
+}
+
+void CircleModel2D::Objective_Function_Batch(std::span<const std::vector<double>> candidates, std::span<double> values) {
+	// the subset is sparse and small, the batch kernel pays off on the full data
+	if (!mSubset_Indices.empty()) {
+		Experiment::Objective_Function_Batch(candidates, values);
+		return;
+	}
+
+	std::vector<double> centersX(candidates.size()), centersY(candidates.size()), radii(candidates.size());
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (candidates[i].size() != 3) {
+			throw std::invalid_argument("Expected 3 parameters: x, y and radius");
+		}
+		centersX[i] = candidates[i][0];
+		centersY[i] = candidates[i][1];
+		radii[i] = candidates[i][2];
+	}
+
+	Kernels::Sum_Squared_Circle_Residuals_Batch(mData_Points.Points(), centersX, centersY, radii, values);
+	for (auto& value : values) {
+		value /= mData_Points.size();
 	}
-	return totalError / mData_Points.size();
 }
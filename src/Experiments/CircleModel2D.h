@@ -8,13 +8,14 @@
 #pragma once
 
 #include "../Core/Experiment.h"
+#include "../Core/Dataset.h"
 
 #include <vector>
 #include "raylib.h"
 
 class CircleModel2D : public Experiment {
 	private:
-		std::vector<Vector2> mData_Points;
+		TPoint_Set mData_Points;
 
 	public:
 		CircleModel2D() = default;
@@ -25,10 +26,19 @@ class CircleModel2D : public Experiment {
 		bool On_Update(float delta_time) override;
 		bool On_Render() override;
 
-		void Draw_Candidate(const std::vector<double>& candidate, bool best = false) override;
+		void Draw_Candidate(const std::vector<double>& candidate, bool best = false, NDraw_Detail detail = NDraw_Detail::Full) override;
 		double Objective_Function(const std::vector<double>& parameters) override;
+		void Objective_Function_Batch(std::span<const std::vector<double>> candidates, std::span<double> values) override;
+		bool Has_Batch_Objective() const override { return true; }
 		void Fill_Optimizer_Setup(TOptimizer_Setup& setup) override;
 		bool Check_Can_Optimize() override;
 		void Reset_Data() override;
 		bool Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPositionY) override;
+		bool Load_Dataset(const TDataset& dataset) override;
+
+	protected:
+		size_t Data_Point_Count() const override { return mData_Points.size(); }
+		uint64_t Data_Revision() const override { return mData_Points.Revision(); }
+		void Save_Checkpoint_Data(TBinary_Writer& writer) const override;
+		bool Load_Checkpoint_Data(TBinary_Reader& reader) override;
 };
@@ -10,6 +10,7 @@
 #include "../Core/DrawProxy.h"
 #include "../Core/Optimizer.h"
 #include "../Core/Helpers.h"
+#include "../Core/Kernels.h"
 
 #include "../Optimizers/GeneticAlgorithm.h"
 
@@ -24,10 +25,8 @@ bool Clustering2D::On_Init() {
 }
 
 bool Clustering2D::On_Cleanup() {
+	Stop_Optimization();
 	mData_Points.clear();
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
-	}
 	return true;
 }
 
@@ -40,11 +39,27 @@ void Clustering2D::Reset_Data() {
 	mData_Points.clear();
 }
 
+void Clustering2D::Save_Checkpoint_Data(TBinary_Writer& writer) const {
+	writer.Write<int32_t>(mNum_Centroids);
+	Save_Points(writer, mData_Points);
+}
+
+bool Clustering2D::Load_Checkpoint_Data(TBinary_Reader& reader) {
+	int32_t numCentroids = 0;
+	if (!reader.Read(numCentroids) || numCentroids < 2 || numCentroids > 15) {
+		return false;
+	}
+	mNum_Centroids = numCentroids;
+	// the input is parsed to mNum_Centroids on every frame
+	mInputState_Num_Centroids.text = std::to_string(numCentroids);
+	return Load_Points(reader, mData_Points);
+}
+
 bool Clustering2D::On_Render() {
 
 	TSimple_Input inputA(400, 70, 100, 30, "Number of centroids:", mInputState_Num_Centroids, NAppFont::RegularText, NInput_Mask::Numeric, 4);
 
-	if (mIs_Optimizing) {
+	if (Is_Optimizing()) {
 		mInputState_Num_Centroids.isActive = false;
 	}
 
@@ -78,46 +93,69 @@ bool Clustering2D::On_Render() {
 		mData_Points.push_back(GetMousePosition());
 	}
 
-	if (mData_Points.size() > 0) {
+	Update_Point_Clusters();
+
+	// the layer is re-rasterized when the points or their clusters change
+	mData_Layer.Update(mPoint_Clusters_Version, [this]() {
 		std::array<Color, 15> pointColors = { RED, GREEN, BLUE, ORANGE, PURPLE, YELLOW, PINK, SKYBLUE, VIOLET, LIME, GOLD, DARKGREEN, DARKBLUE, BROWN, MAROON };
 
-		for (const auto& point : mData_Points) {
-			// select closest centroid to determine color
-			Color pointColor = LIGHTGRAY;
-			if (mCandidates.size() > 0) {
-				std::unique_lock<std::mutex> lock(mCandidates_Mutex, std::defer_lock);
-				if (mIs_Optimizing) {
-					lock.lock();
-				}
-				if (!mCandidates.empty()) {
-					const auto& bestCandidate = mCandidates[0];
-					double minDistSq = std::numeric_limits<double>::infinity();
-					int closestCentroidIdx = -1;
-					for (int i = 0; i < mNum_Centroids; ++i) {
-						double cx = bestCandidate[2 * i];
-						double cy = bestCandidate[2 * i + 1];
-						double dx = point.x - cx;
-						double dy = point.y - cy;
-						double distSq = dx * dx + dy * dy;
-						if (distSq < minDistSq) {
-							minDistSq = distSq;
-							closestCentroidIdx = i;
-						}
-					}
-					if (closestCentroidIdx >= 0 && closestCentroidIdx < static_cast<int>(pointColors.size())) {
-						pointColor = pointColors[closestCentroidIdx];
-					}
-				}
-			}
+		mData_Cloud.Resize(mData_Points.size());
+		for (size_t i = 0; i < mData_Points.size(); ++i) {
+			// color by the closest centroid
+			const uint8_t cluster = mPoint_Clusters[i];
+			const Color pointColor = (cluster < pointColors.size()) ? pointColors[cluster] : LIGHTGRAY;
 
-			DrawCircleV(point, 3, pointColor);
+			mData_Cloud.Set(i, mData_Points[i], pointColor);
 		}
-	}
+		mData_Cloud.Draw(3.0f);
+	});
+	mData_Layer.Draw();
 
 	return Experiment::On_Render();
 }
 
-void Clustering2D::Draw_Candidate(const std::vector<double>& candidate, bool best) {
+void Clustering2D::Update_Point_Clusters() {
+	const bool candidatesChanged = Refresh_Render_Candidates() || mPoint_Clusters_Candidates_Revision != mRender_Candidates_Revision;
+	if (!candidatesChanged && mPoint_Clusters_Points_Revision == mData_Points.Revision() && mPoint_Clusters_Num_Centroids == mNum_Centroids
+		&& mPoint_Clusters.size() == mData_Points.size()) {
+		return;
+	}
+
+	mPoint_Clusters_Version++;
+	mPoint_Clusters_Candidates_Revision = mRender_Candidates_Revision;
+	mPoint_Clusters_Points_Revision = mData_Points.Revision();
+	mPoint_Clusters_Num_Centroids = mNum_Centroids;
+
+	mPoint_Clusters.assign(mData_Points.size(), No_Cluster);
+
+	// the centroid count may have been changed after the optimization
+	if (mRender_Candidates.empty() || mRender_Candidates[0].size() != 2 * static_cast<size_t>(mNum_Centroids)) {
+		return;
+	}
+
+	const auto& bestCandidate = mRender_Candidates[0];
+	for (size_t p = 0; p < mData_Points.size(); ++p) {
+		const auto& point = mData_Points[p];
+		double minDistSq = std::numeric_limits<double>::infinity();
+		int closestCentroidIdx = -1;
+		for (int i = 0; i < mNum_Centroids; ++i) {
+			double cx = bestCandidate[2 * i];
+			double cy = bestCandidate[2 * i + 1];
+			double dx = point.x - cx;
+			double dy = point.y - cy;
+			double distSq = dx * dx + dy * dy;
+			if (distSq < minDistSq) {
+				minDistSq = distSq;
+				closestCentroidIdx = i;
+			}
+		}
+		if (closestCentroidIdx >= 0) {
+			mPoint_Clusters[p] = static_cast<uint8_t>(closestCentroidIdx);
+		}
+	}
+}
+
+void Clustering2D::Draw_Candidate(const std::vector<double>& candidate, bool best, NDraw_Detail detail) {
 	if (candidate.size() == 2*mNum_Centroids) {
 		for (int i = 0; i < mNum_Centroids; ++i) {
 			const float cx = static_cast<float>(candidate[2 * i]);
@@ -141,6 +179,10 @@ void Clustering2D::Draw_Candidate(const std::vector<double>& candidate, bool bes
 				}
 				DrawCircleLines(static_cast<int>(cx), static_cast<int>(cy), minDist / 2.0f, DARKGREEN);
 			}
+			else if (detail == NDraw_Detail::Reduced) {
+				// other candidates, cheap marker
+				DrawRectangle(static_cast<int>(cx) - 2, static_cast<int>(cy) - 2, 5, 5, LIGHTGRAY);
+			}
 			else {
 				// other candidates
 				DrawCircleV({ cx, cy }, 5.0f, LIGHTGRAY);
@@ -162,6 +204,12 @@ bool Clustering2D::Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPositi
 	return false;
 }
 
+bool Clustering2D::Load_Dataset(const TDataset& dataset) {
+	// dataset points are expected in screen coordinates
+	dataset.View_All(mData_Points);
+	return true;
+}
+
 void Clustering2D::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 	setup.maxIterations = 2000;
 	setup.populationSize = 100;
@@ -182,8 +230,11 @@ double Clustering2D::Objective_Function(const std::vector<double>& parameters) {
 	}
 
 	// k-means clustering objective: sum of squared distances from each point to the nearest centroid
+	if (mSubset_Indices.empty()) {
+		return Kernels::Sum_Min_Squared_Distances(mData_Points.Points(), parameters);
+	}
 	double totalError = 0.0;
-	for (const auto& point : mData_Points) {
+	For_Each_Sample(mData_Points.Points(), [&](const Vector2& point) {
 		double minDistSq = std::numeric_limits<double>::infinity();
 		for (int i = 0; i < mNum_Centroids; ++i) {
 			double cx = parameters[2 * i];
@@ -196,6 +247,7 @@ double Clustering2D::Objective_Function(const std::vector<double>& parameters) {
 			}
 		}
 		totalError += minDistSq;
-	}
-	return totalError;
+	});
+	// scale the subset sum, so it estimates the full data sum
+	return totalError * static_cast<double>(mData_Points.size()) / static_cast<double>(Sample_Count(mData_Points.size()));
 }
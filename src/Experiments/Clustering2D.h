@@ -8,6 +8,7 @@
 #pragma once
 
 #include "../Core/Experiment.h"
+#include "../Core/Dataset.h"
 #include "../Core/Helpers.h"
 
 #include <vector>
@@ -15,12 +16,25 @@
 
 class Clustering2D : public Experiment {
 	private:
-		std::vector<Vector2> mData_Points;
+		TPoint_Set mData_Points;
 
 		int mNum_Centroids = 100;
 
 		TSimple_Input_State mInputState_Num_Centroids;
 
+		// nearest centroid of the best candidate for each data point (No_Cluster if there is no candidate)
+		static constexpr uint8_t No_Cluster = 0xFF;
+		std::vector<uint8_t> mPoint_Clusters;
+		// state the point clusters were computed for
+		uint64_t mPoint_Clusters_Candidates_Revision = 0;
+		uint64_t mPoint_Clusters_Points_Revision = 0;
+		int mPoint_Clusters_Num_Centroids = 0;
+		// incremented on every recomputation of mPoint_Clusters
+		uint64_t mPoint_Clusters_Version = 0;
+
+		// recomputes mPoint_Clusters if the best candidate or data points changed
+		void Update_Point_Clusters();
+
 	public:
 		Clustering2D() = default;
 		virtual ~Clustering2D() = default;
@@ -30,10 +44,17 @@ class Clustering2D : public Experiment {
 		bool On_Update(float delta_time) override;
 		bool On_Render() override;
 
-		void Draw_Candidate(const std::vector<double>& candidate, bool best = false) override;
+		void Draw_Candidate(const std::vector<double>& candidate, bool best = false, NDraw_Detail detail = NDraw_Detail::Full) override;
 		double Objective_Function(const std::vector<double>& parameters) override;
 		void Fill_Optimizer_Setup(TOptimizer_Setup& setup) override;
 		bool Check_Can_Optimize() override;
 		void Reset_Data() override;
 		bool Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPositionY) override;
+		bool Load_Dataset(const TDataset& dataset) override;
+
+	protected:
+		size_t Data_Point_Count() const override { return mData_Points.size(); }
+		uint64_t Data_Revision() const override { return mData_Points.Revision(); }
+		void Save_Checkpoint_Data(TBinary_Writer& writer) const override;
+		bool Load_Checkpoint_Data(TBinary_Reader& reader) override;
 };
@@ -8,8 +8,11 @@
 #include "Fourier2D.h"
 
 #include <numbers>
-#include <thread>
-#include <chrono>
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
 
 #include "../Core/DrawProxy.h"
 #include "../Core/Optimizer.h"
@@ -20,99 +23,302 @@
 namespace {
 
 	bool gen_audioDeviceInitialized = false;
+	bool gen_streamLoaded = false;
 
 	constexpr size_t playbackTimeSecs = 2;
 	constexpr unsigned int sampleRate = 44100;
 	constexpr double sampleRateFloat = static_cast<double>(sampleRate);
-
-	size_t gen_numHarmonics = 3;
-	std::vector<double> gen_bestCandidate;
-	double maxAmplitude = 1.0;
+	constexpr uint64_t playbackFrames = static_cast<uint64_t>(playbackTimeSecs) * sampleRate;
 
 	AudioStream stream;
-	int gen_time = 0;
 
-	std::chrono::time_point<std::chrono::steady_clock> gen_startTime;
+	// harmonics supported by the audio synthesis (fixed, so the audio thread never allocates)
+	constexpr size_t maxHarmonics = 16;
+	// new coefficients are reached by a linear ramp over this many frames, so the updates do not click
+	constexpr unsigned int rampFrames = 1024;
+
+	/**
+	 * Normalized coefficients of a candidate; the frequency is stored as a per-sample phasor rotation
+	 */
+	struct TCoefficients {
+		size_t count = 0;
+		std::array<double, maxHarmonics> an{};
+		std::array<double, maxHarmonics> bn{};
+		std::array<double, maxHarmonics> rotRe{};
+		std::array<double, maxHarmonics> rotIm{};
+	};
+
+	/**
+	 * Lock-free single producer, single consumer triple buffer; the producer always has a slot to write to,
+	 * the consumer always reads the latest published slot, and neither of them ever waits
+	 */
+	template<typename T>
+	class TTriple_Buffer {
+		private:
+			static constexpr uint8_t Index_Mask = 0x3;
+			static constexpr uint8_t Dirty_Bit = 0x4;
+
+			std::array<T, 3> mSlots{};
+			// slot exchanged between the producer and the consumer; Dirty_Bit is set when it has not been read yet
+			std::atomic<uint8_t> mShared{ 1 };
+			// owned by the producer
+			uint8_t mBack = 0;
+			// owned by the consumer
+			uint8_t mFront = 2;
+
+		public:
+			T& Back() {
+				return mSlots[mBack];
+			}
+
+			// publish the back slot, the producer gets a new back slot
+			void Publish() {
+				mBack = mShared.exchange(mBack | Dirty_Bit, std::memory_order_acq_rel) & Index_Mask;
+			}
+
+			// take the latest published slot, if there is any; returns true if the front slot changed
+			bool Acquire() {
+				if ((mShared.load(std::memory_order_relaxed) & Dirty_Bit) == 0) {
+					return false;
+				}
+				mFront = mShared.exchange(mFront, std::memory_order_acq_rel) & Index_Mask;
+				return true;
+			}
+
+			const T& Front() const {
+				return mSlots[mFront];
+			}
+	};
+
+	/**
+	 * Harmonic oscillator; the phasor (re, im) = (cos, sin) of the current phase is rotated by a constant
+	 * per-sample rotation, so the samples are generated without any trigonometric calls; the phasor
+	 * is kept when the coefficients change, so the phase stays continuous
+	 */
+	struct TOscillator {
+		double an = 0.0;
+		double bn = 0.0;
+		double anStep = 0.0;
+		double bnStep = 0.0;
+		double anTarget = 0.0;
+		double bnTarget = 0.0;
+		double rotRe = 1.0;
+		double rotIm = 0.0;
+		double re = 1.0;
+		double im = 0.0;
+	};
+
+	TTriple_Buffer<TCoefficients> gen_coefficients;
+	// serializes the producers (UI thread and optimizer callback); the audio thread never locks it
+	std::mutex gen_publishMutex;
+
+	// frames left to play; set by the UI thread to start the playback, counted down by the audio callback
+	std::atomic<uint64_t> gen_remainingFrames{ 0 };
+	// continuous playback of the latest published coefficients
+	std::atomic<bool> gen_livePreview{ false };
+	// set by the UI thread when the playback starts from silence (the stream is stopped once the playback ends,
+	// so the audio callback does not see the end itself)
+	std::atomic<bool> gen_restartPlayback{ false };
+
+	// audio thread state
+	std::array<TOscillator, maxHarmonics> gen_oscillators;
+	size_t gen_oscillatorCount = 0;
+	unsigned int gen_rampLeft = 0;
+
+	// computes the normalized coefficients of the candidate, returns false if it cannot be played
+	bool Fill_Coefficients(const std::vector<double>& candidate, size_t numHarmonics, TCoefficients& target) {
+		if (numHarmonics > maxHarmonics || candidate.size() != numHarmonics * 3) {
+			return false;
+		}
+
+		double maxAmplitude = 0.0;
+		for (size_t n = 0; n < numHarmonics; n++) {
+			maxAmplitude += std::abs(candidate[n * 3 + 0]) + std::abs(candidate[n * 3 + 1]);
+		}
+		if (maxAmplitude <= 0.0) {
+			return false;
+		}
+
+		// the only trigonometric calls - one rotation per harmonic
+		target.count = numHarmonics;
+		for (size_t n = 0; n < numHarmonics; n++) {
+			const double wn = candidate[n * 3 + 2] * 150.0;
+			const double phaseStep = wn * 2.0 * std::numbers::pi / sampleRateFloat;
+
+			target.an[n] = candidate[n * 3 + 0] / maxAmplitude; // normalize to -1..1
+			target.bn[n] = candidate[n * 3 + 1] / maxAmplitude;
+			target.rotRe[n] = std::cos(phaseStep);
+			target.rotIm[n] = std::sin(phaseStep);
+		}
+
+		return true;
+	}
+
+	bool Publish_Candidate(const std::vector<double>& candidate, size_t numHarmonics) {
+		std::lock_guard<std::mutex> lock(gen_publishMutex);
+		if (!Fill_Coefficients(candidate, numHarmonics, gen_coefficients.Back())) {
+			return false;
+		}
+		gen_coefficients.Publish();
+		return true;
+	}
 
-	std::vector<short> gen_outBuffer;
+	// audio thread: start ramping the oscillators to the new coefficients
+	void Retarget_Oscillators(const TCoefficients& coefs) {
+		// the removed harmonics fade out, the added ones fade in
+		const size_t count = std::max(gen_oscillatorCount, coefs.count);
+		for (size_t n = 0; n < count; n++) {
+			auto& osc = gen_oscillators[n];
+			if (n >= gen_oscillatorCount) {
+				osc = TOscillator{};
+			}
+			osc.anTarget = n < coefs.count ? coefs.an[n] : 0.0;
+			osc.bnTarget = n < coefs.count ? coefs.bn[n] : 0.0;
+			osc.anStep = (osc.anTarget - osc.an) / rampFrames;
+			osc.bnStep = (osc.bnTarget - osc.bn) / rampFrames;
+			if (n < coefs.count) {
+				osc.rotRe = coefs.rotRe[n];
+				osc.rotIm = coefs.rotIm[n];
+			}
+		}
+		gen_oscillatorCount = count;
+		gen_rampLeft = rampFrames;
+	}
 
 	void generateSamples(void* buffer, unsigned int frames) {
 
 		short* samples = (short*)buffer;
 
-		for (unsigned int i = 0; i < frames; i++) {
-			if (gen_time < (int)gen_outBuffer.size()) {
-				samples[i] = gen_outBuffer[gen_time];
+		const bool live = gen_livePreview.load(std::memory_order_acquire);
+		const uint64_t remaining = gen_remainingFrames.load(std::memory_order_acquire);
+		const unsigned int playFrames = live ? frames : static_cast<unsigned int>(std::min<uint64_t>(remaining, frames));
+
+		std::fill(samples + playFrames, samples + frames, static_cast<short>(0));
+		if (playFrames == 0) {
+			return;
+		}
+
+		// starting from silence - fade in from zero amplitude
+		if (gen_restartPlayback.exchange(false, std::memory_order_acq_rel)) {
+			gen_oscillatorCount = 0;
+			Retarget_Oscillators(gen_coefficients.Front());
+		}
+
+		if (gen_coefficients.Acquire()) {
+			Retarget_Oscillators(gen_coefficients.Front());
+		}
+
+		for (unsigned int i = 0; i < playFrames; i++) {
+			const bool ramping = gen_rampLeft > 0;
+			if (ramping) {
+				gen_rampLeft--;
 			}
-			else {
-				samples[i] = 0;
+
+			double wavepoint = 0.0;
+			for (size_t n = 0; n < gen_oscillatorCount; n++) {
+				auto& osc = gen_oscillators[n];
+				if (ramping) {
+					osc.an = gen_rampLeft > 0 ? osc.an + osc.anStep : osc.anTarget;
+					osc.bn = gen_rampLeft > 0 ? osc.bn + osc.bnStep : osc.bnTarget;
+				}
+
+				wavepoint += osc.an * osc.re + osc.bn * osc.im;
+
+				const double re = osc.re * osc.rotRe - osc.im * osc.rotIm;
+				osc.im = osc.re * osc.rotIm + osc.im * osc.rotRe;
+				osc.re = re;
 			}
-			gen_time++;
+			samples[i] = static_cast<short>(std::clamp(wavepoint, -1.0, 1.0) * 32767);
+		}
+
+		// pull the phasors back to the unit circle, so the rounding errors do not accumulate over long playback
+		for (size_t n = 0; n < gen_oscillatorCount; n++) {
+			auto& osc = gen_oscillators[n];
+			const double norm = (3.0 - (osc.re * osc.re + osc.im * osc.im)) * 0.5;
+			osc.re *= norm;
+			osc.im *= norm;
+		}
+
+		if (!live) {
+			gen_remainingFrames.store(remaining - playFrames, std::memory_order_release);
+		}
+	}
+
+	void Ensure_Audio_Stream() {
+		if (!gen_audioDeviceInitialized) {
+			gen_audioDeviceInitialized = true;
+			// make sure the audio device is initialized only once
+			// we will close it when the experiment is cleaned up
+			// raylib does not support re-initialization of the audio device
+			InitAudioDevice();
+		}
+
+		if (!gen_streamLoaded) {
+			gen_streamLoaded = true;
+			SetAudioStreamBufferSizeDefault(4096);
+			stream = LoadAudioStream(sampleRate, 16, 1);
+			SetAudioStreamCallback(stream, generateSamples);
 		}
 	}
 }
 
 void Fourier2D::Play_Sound() {
 
-	if (mCandidates.size() == 0) {
+	if (gen_livePreview.load(std::memory_order_relaxed) || gen_remainingFrames.load(std::memory_order_acquire) != 0) {
+		// already playing
 		return;
 	}
 
-	if (gen_time != 0) {
-		// already playing
-		return;
+	std::vector<double> bestCandidate;
+	{
+		std::lock_guard<std::mutex> lock(mCandidates_Mutex);
+		if (mCandidates.empty()) {
+			return;
+		}
+		bestCandidate = mCandidates[0];
 	}
 
-	gen_numHarmonics = mNum_Harmonics;
-	gen_bestCandidate = mCandidates[0];
-	maxAmplitude = 0.0;
-	for (size_t n = 0; n < mNum_Harmonics; n++) {
-		const double an = gen_bestCandidate[n * 3 + 0];
-		const double bn = gen_bestCandidate[n * 3 + 1];
-		maxAmplitude += std::abs(an) + std::abs(bn);
+	if (!Publish_Candidate(bestCandidate, mNum_Harmonics)) {
+		return;
 	}
 
-	gen_outBuffer.resize(sampleRate * playbackTimeSecs);
+	Ensure_Audio_Stream();
 
-	for (unsigned int i = 0; i < sampleRate * playbackTimeSecs; i++) {
-		double wavepoint = 0.0;
-		for (size_t n = 0; n < gen_numHarmonics; n++) {
-			if (gen_bestCandidate.size() > 0) {
-				const double an = gen_bestCandidate[n * 3 + 0];
-				const double bn = gen_bestCandidate[n * 3 + 1];
-				const double wn = gen_bestCandidate[n * 3 + 2] * 150.0;
-				wavepoint += an * std::cos(wn * ((gen_time / sampleRateFloat) * 2.0 * std::numbers::pi)) + bn * std::sin(wn * ((gen_time / sampleRateFloat) * 2.0 * std::numbers::pi));
-			}
-		}
-		wavepoint /= maxAmplitude; // normalize to -1..1
-		gen_outBuffer[i] = (short)(wavepoint * 32767);
-		gen_time++;
-	}
+	gen_restartPlayback.store(true, std::memory_order_release);
+	gen_remainingFrames.store(playbackFrames, std::memory_order_release);
+	PlayAudioStream(stream);
+}
 
-	gen_time = 0;
+void Fourier2D::Toggle_Live_Preview() {
+	if (gen_livePreview.load(std::memory_order_relaxed)) {
+		gen_livePreview.store(false, std::memory_order_release);
+		return;
+	}
 
-	if (!gen_audioDeviceInitialized) {
-		gen_audioDeviceInitialized = true;
-		// make sure the audio device is initialized only once
-		// we will close it when the sound playback is done
-		// raylib does not support re-initialization of the audio device
-		InitAudioDevice();
+	// start with the current best candidate (if any), the optimizer publishes the improved ones
+	std::vector<double> bestCandidate;
+	{
+		std::lock_guard<std::mutex> lock(mCandidates_Mutex);
+		if (!mCandidates.empty()) {
+			bestCandidate = mCandidates[0];
+		}
 	}
+	Publish_Candidate(bestCandidate, mNum_Harmonics);
 
-	gen_startTime = std::chrono::steady_clock::now();
+	Ensure_Audio_Stream();
 
-	std::thread thr([]() {
-		// play sound using raylib and callback, that samples the best candidate
-		stream = LoadAudioStream(sampleRate, 16, 1);
-		SetAudioStreamBufferSizeDefault(4096);
-		SetAudioStreamCallback(stream, generateSamples);
-		PlayAudioStream(stream);
+	// joining a running one-shot playback continues with its oscillators
+	if (gen_remainingFrames.load(std::memory_order_acquire) == 0) {
+		gen_restartPlayback.store(true, std::memory_order_release);
+	}
+	gen_livePreview.store(true, std::memory_order_release);
+	PlayAudioStream(stream);
+}
 
-		std::this_thread::sleep_for(std::chrono::seconds(playbackTimeSecs));
-		gen_time = 0;
-		UnloadAudioStream(stream);
-	});
-	thr.detach();
+void Fourier2D::Cache_Best_Candidate(double bestMetric, const std::vector<std::vector<double>>& population) {
+	if (gen_livePreview.load(std::memory_order_relaxed) && !population.empty()) {
+		Publish_Candidate(population[0], mNum_Harmonics);
+	}
 }
 
 Vector2 Fourier2D::From_Screen_To_Cartesian(const Vector2& screenPoint) const {
@@ -137,9 +343,14 @@ bool Fourier2D::On_Init() {
 }
 
 bool Fourier2D::On_Cleanup() {
+	Stop_Optimization();
 	mData_Points.clear();
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
+	if (gen_streamLoaded) {
+		gen_streamLoaded = false;
+		// the callback is not called anymore once the stream is unloaded
+		UnloadAudioStream(stream);
+		gen_remainingFrames.store(0, std::memory_order_release);
+		gen_livePreview.store(false, std::memory_order_release);
 	}
 	if (gen_audioDeviceInitialized) {
 		// close the audio device if it was initialized
@@ -150,6 +361,11 @@ bool Fourier2D::On_Cleanup() {
 }
 
 bool Fourier2D::On_Update(float delta_time) {
+	// the stream is kept loaded, only stop it when the playback is done
+	const bool playing = gen_livePreview.load(std::memory_order_relaxed) || gen_remainingFrames.load(std::memory_order_acquire) != 0;
+	if (gen_streamLoaded && !playing && IsAudioStreamPlaying(stream)) {
+		StopAudioStream(stream);
+	}
 	return true;
 }
 
@@ -158,39 +374,59 @@ void Fourier2D::Reset_Data() {
 	mData_Points.clear();
 }
 
+void Fourier2D::Save_Checkpoint_Data(TBinary_Writer& writer) const {
+	Save_Points(writer, mData_Points);
+}
+
+bool Fourier2D::Load_Checkpoint_Data(TBinary_Reader& reader) {
+	return Load_Points(reader, mData_Points);
+}
+
 bool Fourier2D::On_Render() {
 
 	TSimple_Button playBtn(GetScreenWidth() - 10 - 200 - 10, 50, 100, 30, "Play Sound");
-	if (playBtn.Render()) {
+	TSimple_Button liveBtn(GetScreenWidth() - 10 - 200 - 10, 90, 100, 30, gen_livePreview.load(std::memory_order_relaxed) ? "Live: on" : "Live: off");
+	const bool playClicked = playBtn.Render();
+	const bool liveClicked = liveBtn.Render();
+	if (playClicked) {
 		Play_Sound();
 	}
+	else if (liveClicked) {
+		Toggle_Live_Preview();
+	}
 	else {
 		if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !Is_Mouse_In_UI_Area()) {
 			mData_Points.push_back(From_Screen_To_Cartesian(GetMousePosition()));
 		}
 	}
 
-	if (gen_time != 0) {
-		const auto now = std::chrono::steady_clock::now();
-		const auto elapsed = now - gen_startTime;
-		const double soundPlayProgress = std::min(1.0, std::chrono::duration<double>(elapsed).count() / static_cast<double>(playbackTimeSecs));
+	const uint64_t remainingFrames = gen_remainingFrames.load(std::memory_order_relaxed);
+	if (remainingFrames != 0) {
+		const double soundPlayProgress = 1.0 - static_cast<double>(remainingFrames) / static_cast<double>(playbackFrames);
 
 		DrawRectangle(GetScreenWidth() - 10 - 200 - 10, 50 + 30, static_cast<int>(100.0 * soundPlayProgress), 5, GREEN);
 	}
 
-	for (const auto& point : mData_Points) {
-		DrawCircleV(From_Cartesian_To_Screen(point), 3, RED);
-	}
+	mData_Layer.Update(mData_Points.Revision(), [this]() {
+		// the points are transformed only when they are added to the cloud
+		mData_Cloud.Sync(mData_Points, RED, [this](const Vector2& point) { return From_Cartesian_To_Screen(point); });
+		mData_Cloud.Draw(3.0f);
+	});
+	mData_Layer.Draw();
 
 	return Experiment::On_Render();
 }
 
-void Fourier2D::Draw_Candidate(const std::vector<double>& candidate, bool best) {
+void Fourier2D::Draw_Candidate(const std::vector<double>& candidate, bool best, NDraw_Detail detail) {
 	if (candidate.size() == mNum_Harmonics * 3) {
 
-		Vector2 prevPoint = { 0, 0 };
+		// the curve of the reduced detail candidates is sampled more coarsely
+		const double step = (detail == NDraw_Detail::Reduced) ? 0.05 : 0.01;
+		const size_t stepCount = static_cast<size_t>(4.0 * std::numbers::pi / step) + 1;
 
-		for (double x = 0; x <= 4.0 * std::numbers::pi; x += 0.01) {
+		mCurve_Points.resize(stepCount);
+		for (size_t i = 0; i < stepCount; i++) {
+			const double x = static_cast<double>(i) * step;
 			double y = 0.0f;
 			for (size_t n = 0; n < mNum_Harmonics; n++) {
 				const double an = candidate[n * 3 + 0];
@@ -198,11 +434,16 @@ void Fourier2D::Draw_Candidate(const std::vector<double>& candidate, bool best)
 				const double wn = candidate[n * 3 + 2];
 				y += an * std::cos(wn * x) + bn * std::sin(wn * x);
 			}
-			const Vector2 screenPoint = From_Cartesian_To_Screen({ static_cast<float>(x), static_cast<float>(y) });
-			if (x != 0) {
-				DrawLineEx(prevPoint, screenPoint, best ? 2.0f : 1.0f, best ? BLUE : LIGHTGRAY);
+			mCurve_Points[i] = From_Cartesian_To_Screen({ static_cast<float>(x), static_cast<float>(y) });
+		}
+
+		if (best) {
+			for (size_t i = 1; i < mCurve_Points.size(); i++) {
+				DrawLineEx(mCurve_Points[i - 1], mCurve_Points[i], 2.0f, BLUE);
 			}
-			prevPoint = screenPoint;
+		}
+		else {
+			mLine_Batch.Add_Strip(mCurve_Points, LIGHTGRAY);
 		}
 	}
 }
@@ -220,6 +461,12 @@ bool Fourier2D::Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPositionY
 	return false;
 }
 
+bool Fourier2D::Load_Dataset(const TDataset& dataset) {
+	// dataset points are expected in the cartesian space of the model (x in 0..4*PI)
+	dataset.View_All(mData_Points);
+	return true;
+}
+
 void Fourier2D::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 	setup.maxIterations = 80000;
 	setup.populationSize = 50;
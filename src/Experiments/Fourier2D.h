@@ -8,20 +8,32 @@
 #pragma once
 
 #include "../Core/Experiment.h"
+#include "../Core/Dataset.h"
 
 #include <vector>
 #include "raylib.h"
 
 class Fourier2D : public Experiment {
 	private:
-		std::vector<Vector2> mData_Points;
+		TPoint_Set mData_Points;
 
 		Vector2 From_Screen_To_Cartesian(const Vector2& screenPoint) const;
 		Vector2 From_Cartesian_To_Screen(const Vector2& cartesianPoint) const;
 
 		const size_t mNum_Harmonics = 3;
 
+		// sampled curve of the drawn candidate (reused between candidates)
+		std::vector<Vector2> mCurve_Points;
+
+		// play the best candidate once
 		void Play_Sound();
+		// continuously play the best candidate, updated as the optimizer improves it
+		void Toggle_Live_Preview();
+
+	protected:
+		void Cache_Best_Candidate(double bestMetric, const std::vector<std::vector<double>>& population) override;
+		void Save_Checkpoint_Data(TBinary_Writer& writer) const override;
+		bool Load_Checkpoint_Data(TBinary_Reader& reader) override;
 
 	public:
 		Fourier2D(size_t numHarmonics = 3) : mNum_Harmonics(numHarmonics) {}
@@ -32,10 +44,12 @@ class Fourier2D : public Experiment {
 		bool On_Update(float delta_time) override;
 		bool On_Render() override;
 
-		void Draw_Candidate(const std::vector<double>& candidate, bool best = false) override;
+		void Draw_Candidate(const std::vector<double>& candidate, bool best = false, NDraw_Detail detail = NDraw_Detail::Full) override;
 		double Objective_Function(const std::vector<double>& parameters) override;
+		uint64_t Data_Revision() const override { return mData_Points.Revision(); }
 		void Fill_Optimizer_Setup(TOptimizer_Setup& setup) override;
 		bool Check_Can_Optimize() override;
 		void Reset_Data() override;
 		bool Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPositionY) override;
+		bool Load_Dataset(const TDataset& dataset) override;
 };
@@ -10,6 +10,7 @@
 #include "../Core/DrawProxy.h"
 #include "../Core/Optimizer.h"
 #include "../Core/Helpers.h"
+#include "../Core/Kernels.h"
 
 #include "../Optimizers/GeneticAlgorithm.h"
 
@@ -21,10 +22,8 @@ bool LinearModel2D::On_Init() {
 }
 
 bool LinearModel2D::On_Cleanup() {
+	Stop_Optimization();
 	mData_Points.clear();
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
-	}
 	return true;
 }
 
@@ -37,34 +36,42 @@ void LinearModel2D::Reset_Data() {
 	mData_Points.clear();
 }
 
+void LinearModel2D::Save_Checkpoint_Data(TBinary_Writer& writer) const {
+	Save_Points(writer, mData_Points);
+}
+
+bool LinearModel2D::Load_Checkpoint_Data(TBinary_Reader& reader) {
+	return Load_Points(reader, mData_Points);
+}
+
 bool LinearModel2D::On_Render() {
 
 	if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !Is_Mouse_In_UI_Area()) {
 		mData_Points.push_back(GetMousePosition());
 	}
 
-	for (const auto& point : mData_Points) {
-		DrawCircleV(point, 3, RED);
-	}
+	mData_Layer.Update(mData_Points.Revision(), [this]() {
+		mData_Cloud.Sync(mData_Points, RED);
+		mData_Cloud.Draw(3.0f);
+	});
+	mData_Layer.Draw();
 
 	// draw candidates
-	if (mCandidates.size() > 0) {
-
-		std::unique_lock<std::mutex> lock(mCandidates_Mutex, std::defer_lock);
-		if (mIs_Optimizing) {
-			lock.lock();
-		}
+	Refresh_Render_Candidates();
+	if (mRender_Candidates.size() > 0) {
 
-		const double adjustedSlope = -mCandidates[0][0];
-		const double adjustedIntercept = GetScreenHeight() - mCandidates[0][1];
+		const double adjustedSlope = -mRender_Candidates[0][0];
+		const double adjustedIntercept = GetScreenHeight() - mRender_Candidates[0][1];
 
-		DrawProxy::Text("y = " + std::to_string(adjustedSlope) + " * x + " + std::to_string(adjustedIntercept), 10, GetScreenHeight() - 50, DARKGRAY, NAppFont::RegularText);
+		TText_Buffer equation;
+		equation << "y = " << adjustedSlope << " * x + " << adjustedIntercept;
+		DrawProxy::Text_Uncached(equation.c_str(), 10, GetScreenHeight() - 50, DARKGRAY, NAppFont::RegularText);
 	}
 
 	return Experiment::On_Render();
 }
 
-void LinearModel2D::Draw_Candidate(const std::vector<double>& candidate, bool best) {
+void LinearModel2D::Draw_Candidate(const std::vector<double>& candidate, bool best, NDraw_Detail detail) {
 	if (candidate.size() == 2) {
 		double slope = candidate[0];
 		double intercept = candidate[1];
@@ -80,7 +87,7 @@ void LinearModel2D::Draw_Candidate(const std::vector<double>& candidate, bool be
 		}
 		else {
 			// other candidates
-			DrawLine((int)x1, (int)y1, (int)x2, (int)y2, PINK);
+			mLine_Batch.Add({ x1, y1 }, { x2, y2 }, PINK);
 		}
 	}
 }
@@ -98,6 +105,12 @@ bool LinearModel2D::Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPosit
 	return false;
 }
 
+bool LinearModel2D::Load_Dataset(const TDataset& dataset) {
+	// dataset points are expected in screen coordinates
+	dataset.View_All(mData_Points);
+	return true;
+}
+
 void LinearModel2D::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 	setup.maxIterations = 20000;
 	setup.populationSize = 100;
@@ -114,11 +127,36 @@ double LinearModel2D::Objective_Function(const std::vector<double>& parameters)
 	}
 	double slope = parameters[0];
 	double intercept = parameters[1];
+	if (mSubset_Indices.empty()) {
+		return Kernels::Sum_Squared_Line_Residuals(mData_Points.Points(), slope, intercept) / mData_Points.size();
+	}
 	double totalError = 0.0;
-	for (const auto& point : mData_Points) {
+	For_Each_Sample(mData_Points.Points(), [&](const Vector2& point) {
 		double predictedY = slope * point.x + intercept;
 		double error = point.y - predictedY;
 		totalError += error * error;
+	});
+	return totalError / Sample_Count(mData_Points.size());
+}
+
+void LinearModel2D::Objective_Function_Batch(std::span<const std::vector<double>> candidates, std::span<double> values) {
+	// the subset is sparse and small, the batch kernel pays off on the full data
+	if (!mSubset_Indices.empty()) {
+		Experiment::Objective_Function_Batch(candidates, values);
+		return;
+	}
+
+	std::vector<double> slopes(candidates.size()), intercepts(candidates.size());
+	for (size_t i = 0; i < candidates.size(); i++) {
+		if (candidates[i].size() != 2) {
+			throw std::invalid_argument("Expected 2 parameters: slope and intercept");
+		}
+		slopes[i] = candidates[i][0];
+		intercepts[i] = candidates[i][1];
+	}
+
+	Kernels::Sum_Squared_Line_Residuals_Batch(mData_Points.Points(), slopes, intercepts, values);
+	for (auto& value : values) {
+		value /= mData_Points.size();
 	}
-	return totalError / mData_Points.size();
 }
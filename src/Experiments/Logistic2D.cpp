@@ -12,6 +12,7 @@
 #include "../Core/Helpers.h"
 
 #include "../Optimizers/GeneticAlgorithm.h"
+#include "../Optimizers/FixedGeneticAlgorithm.h"
 
 #include <cmath>
 
@@ -24,11 +25,9 @@ bool Logistic2D::On_Init() {
 }
 
 bool Logistic2D::On_Cleanup() {
+	Stop_Optimization();
 	mData_Points_A.clear();
 	mData_Points_B.clear();
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
-	}
 	return true;
 }
 
@@ -42,6 +41,15 @@ void Logistic2D::Reset_Data() {
 	mData_Points_B.clear();
 }
 
+void Logistic2D::Save_Checkpoint_Data(TBinary_Writer& writer) const {
+	Save_Points(writer, mData_Points_A);
+	Save_Points(writer, mData_Points_B);
+}
+
+bool Logistic2D::Load_Checkpoint_Data(TBinary_Reader& reader) {
+	return Load_Points(reader, mData_Points_A) && Load_Points(reader, mData_Points_B);
+}
+
 bool Logistic2D::On_Render() {
 
 	if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !Is_Mouse_In_UI_Area()) {
@@ -51,17 +59,19 @@ bool Logistic2D::On_Render() {
 		mData_Points_B.push_back(GetMousePosition());
 	}
 
-	for (const auto& point : mData_Points_A) {
-		DrawCircleV(point, 3, RED);
-	}
-	for (const auto& point : mData_Points_B) {
-		DrawCircleV(point, 3, GREEN);
-	}
+	// revisions only grow, so the sum changes whenever any of the sets changes
+	mData_Layer.Update(mData_Points_A.Revision() + mData_Points_B.Revision(), [this]() {
+		mData_Cloud.Sync(mData_Points_A, RED);
+		mData_Cloud.Draw(3.0f);
+		mData_Cloud_B.Sync(mData_Points_B, GREEN);
+		mData_Cloud_B.Draw(3.0f);
+	});
+	mData_Layer.Draw();
 
 	return Experiment::On_Render();
 }
 
-void Logistic2D::Draw_Candidate(const std::vector<double>& candidate, bool best) {
+void Logistic2D::Draw_Candidate(const std::vector<double>& candidate, bool best, NDraw_Detail detail) {
 	// candidate is [w0, w1, w2], we need to draw the line w0 + w1*x + w2*y = 0
 	const double w0 = candidate[0];
 	const double w1 = candidate[1];
@@ -74,10 +84,10 @@ void Logistic2D::Draw_Candidate(const std::vector<double>& candidate, bool best)
 		const double x2 = static_cast<double>(GetScreenWidth());
 		const double y2 = (-w0 - w1 * x2) / w2;
 
-		DrawLine(static_cast<int>(x1), static_cast<int>(y1), static_cast<int>(x2), static_cast<int>(y2), best ? BLUE : LIGHTGRAY);
+		mLine_Batch.Add({ static_cast<float>(x1), static_cast<float>(y1) }, { static_cast<float>(x2), static_cast<float>(y2) }, best ? BLUE : LIGHTGRAY);
 	} else if (std::fabs(w1) > std::numeric_limits<double>::epsilon()) {
 		const double x = -w0 / w1;
-		DrawLine(static_cast<int>(x), 0, static_cast<int>(x), GetScreenHeight(), best ? BLUE : LIGHTGRAY);
+		mLine_Batch.Add({ static_cast<float>(x), 0.0f }, { static_cast<float>(x), static_cast<float>(GetScreenHeight()) }, best ? BLUE : LIGHTGRAY);
 	}
 }
 
@@ -94,6 +104,13 @@ bool Logistic2D::Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPosition
 	return false;
 }
 
+bool Logistic2D::Load_Dataset(const TDataset& dataset) {
+	// class 0 = A (left click), class 1 = B (right click)
+	dataset.View_Class(0, mData_Points_A);
+	dataset.View_Class(1, mData_Points_B);
+	return true;
+}
+
 void Logistic2D::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 	setup.maxIterations = 50000;
 	setup.populationSize = 100;
@@ -105,12 +122,35 @@ void Logistic2D::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 }
 
 double Logistic2D::Objective_Function(const std::vector<double>& parameters) {
+	if (parameters.size() != 3) {
+		throw std::invalid_argument("Expected 3 parameters: theta0, theta1 and theta2");
+	}
+	return Evaluate(std::span<const double, 3>(parameters.data(), 3));
+}
+
+double Logistic2D::Evaluate(std::span<const double, 3> parameters) const {
 	auto h = [parameters](double x, double y) {
 		const double z = parameters[0] + parameters[1] * x + parameters[2] * y;
 		return 1.0 / (1.0 + std::exp(-z));
 	};
 
 	double logLikelihood = 0.0;
+
+	if (!mSubset_Indices.empty()) {
+		// mini-batch: subset indices address A and B concatenated; scale the sum, so it estimates the full data sum
+		const size_t countA = mData_Points_A.size();
+		for (const uint32_t idx : mSubset_Indices) {
+			if (idx < countA) {
+				logLikelihood += -std::log(h(mData_Points_A[idx].x, mData_Points_A[idx].y) + 1e-9);
+			}
+			else {
+				logLikelihood += -std::log(1.0 - h(mData_Points_B[idx - countA].x, mData_Points_B[idx - countA].y) + 1e-9);
+			}
+		}
+
+		return logLikelihood * static_cast<double>(Data_Point_Count()) / static_cast<double>(mSubset_Indices.size());
+	}
+
 	for (size_t i = 0; i < mData_Points_A.size(); ++i) {
 		const double xi = mData_Points_A[i].x, yi = mData_Points_A[i].y;
 		const double hi = h(xi, yi);
@@ -125,3 +165,9 @@ double Logistic2D::Objective_Function(const std::vector<double>& parameters) {
 
 	return logLikelihood;
 }
+
+std::unique_ptr<Optimizer> Logistic2D::Create_Fixed_Optimizer(double mutationRate, double crossoverRate) {
+	return Make_Fixed_Genetic_Algorithm<3>([this](const TFixed_Genome<3>& parameters) {
+		return Evaluate(parameters);
+	}, mutationRate, crossoverRate);
+}
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "../Core/Experiment.h"
+#include "../Core/Dataset.h"
 #include "../Core/Helpers.h"
 
 #include <vector>
@@ -15,8 +16,14 @@
 
 class Logistic2D : public Experiment {
 	private:
-		std::vector<Vector2> mData_Points_A;
-		std::vector<Vector2> mData_Points_B;
+		TPoint_Set mData_Points_A;
+		TPoint_Set mData_Points_B;
+
+		// points of class B (class A points use the base mData_Cloud)
+		TPoint_Cloud mData_Cloud_B;
+
+		// negative log-likelihood of the parameters (theta0, theta1, theta2)
+		double Evaluate(std::span<const double, 3> parameters) const;
 
 	public:
 		Logistic2D() = default;
@@ -27,10 +34,18 @@ class Logistic2D : public Experiment {
 		bool On_Update(float delta_time) override;
 		bool On_Render() override;
 
-		void Draw_Candidate(const std::vector<double>& candidate, bool best = false) override;
+		void Draw_Candidate(const std::vector<double>& candidate, bool best = false, NDraw_Detail detail = NDraw_Detail::Full) override;
 		double Objective_Function(const std::vector<double>& parameters) override;
 		void Fill_Optimizer_Setup(TOptimizer_Setup& setup) override;
 		bool Check_Can_Optimize() override;
 		void Reset_Data() override;
 		bool Draw_Cannot_Optimize_Reason(int hintPositionX, int hintPositionY) override;
+		bool Load_Dataset(const TDataset& dataset) override;
+		std::unique_ptr<Optimizer> Create_Fixed_Optimizer(double mutationRate, double crossoverRate) override;
+
+	protected:
+		size_t Data_Point_Count() const override { return mData_Points_A.size() + mData_Points_B.size(); }
+		uint64_t Data_Revision() const override { return mData_Points_A.Revision() + mData_Points_B.Revision(); }
+		void Save_Checkpoint_Data(TBinary_Writer& writer) const override;
+		bool Load_Checkpoint_Data(TBinary_Reader& reader) override;
 };
@@ -39,9 +39,7 @@ bool NumPower::On_Init() {
 }
 
 bool NumPower::On_Cleanup() {
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
-	}
+	Stop_Optimization();
 	return true;
 }
 
@@ -61,35 +59,43 @@ bool NumPower::On_Render() {
 	return Experiment::On_Render();
 }
 
-void NumPower::Draw_Candidate(const std::vector<double>& candidate, bool best) {
+void NumPower::Draw_Candidate(const std::vector<double>& candidate, bool best, NDraw_Detail detail) {
 	if (candidate.size() == Parameters_Count && best) {
-		auto machine = Create_Machine();
+		if (candidate != mDrawn_Candidate) {
+			mDrawn_Candidate = candidate;
+
+			auto machine = Create_Machine();
+			mDrawn_Program = machine.Transcribe(candidate);
+
+			// run for inputs 0 to 10 and store the output
+			mDrawn_Outputs.clear();
+			for (int i = 0; i <= 10; i++) {
+				std::vector<double> input = { static_cast<double>(i) };
+				std::vector<double> memory = candidate; // program is in the memory
+				auto output = machine.Run(input, memory);
+				std::string outputStr;
+				if (output.size() != 1) {
+					outputStr = "Invalid output";
+				}
+				else {
+					outputStr = std::to_string(output[0]);
+				}
+				mDrawn_Outputs.push_back("Input: " + std::to_string(i) + " | Expected: " + std::to_string(std::pow(static_cast<double>(i), 2.1)) + " | Output: " + outputStr);
+			}
+		}
 
-		auto program = machine.Transcribe(candidate);
 		int startX = 10;
 		int startY = 90;
 		int lineHeight = 20;
-		for (size_t i = 0; i < program.size(); i++) {
+		for (size_t i = 0; i < mDrawn_Program.size(); i++) {
 			Color color = DARKPURPLE;
-			DrawProxy::Text(program[i], startX, startY + static_cast<int>(i) * lineHeight, color, NAppFont::RegularText);
+			DrawProxy::Text(mDrawn_Program[i], startX, startY + static_cast<int>(i) * lineHeight, color, NAppFont::RegularText);
 		}
 
-		// run for inputs 0 to 10 and show the output
-		int outputStartY = startY + static_cast<int>(program.size()) * lineHeight + 20;
-		for (int i = 0; i <= 10; i++) {
-			std::vector<double> input = { static_cast<double>(i) };
-			std::vector<double> memory = candidate; // program is in the memory
-			auto output = machine.Run(input, memory);
-			std::string outputStr;
-			if (output.size() != 1) {
-				outputStr = "Invalid output";
-			}
-			else {
-				outputStr = std::to_string(output[0]);
-			}
-			std::string line = "Input: " + std::to_string(i) + " | Expected: " + std::to_string(std::pow(static_cast<double>(i), 2.1)) + " | Output: " + outputStr;
+		int outputStartY = startY + static_cast<int>(mDrawn_Program.size()) * lineHeight + 20;
+		for (size_t i = 0; i < mDrawn_Outputs.size(); i++) {
 			Color color = DARKBLUE;
-			DrawProxy::Text(line, startX, outputStartY + i * lineHeight, color, NAppFont::RegularText);
+			DrawProxy::Text_Uncached(mDrawn_Outputs[i].c_str(), startX, outputStartY + static_cast<int>(i) * lineHeight, color, NAppFont::RegularText);
 		}
 	}
 }
@@ -110,6 +116,13 @@ void NumPower::Fill_Optimizer_Setup(TOptimizer_Setup& setup) {
 	setup.upperBounds = std::vector<double>(Parameters_Count, 1.0); // constants and instructions
 	setup.initialGuess = std::vector<double>(Parameters_Count, 0.0); // nulls or NOPs
 	setup.sensitivity = std::vector<double>(Parameters_Count, 0.1); // small mutations
+
+	// the search gets stuck in local minima - restart with larger populations (IPOP) rather than waiting it out
+	setup.stagnationAction = NStagnation_Action::Restart;
+	setup.stagnationPatience = 500;
+	setup.diversityThreshold = 0.005;
+	setup.maxRestarts = 5;
+	setup.restartPopulationGrowth = 2.0;
 }
 
 double NumPower::Objective_Function(const std::vector<double>& parameters) {
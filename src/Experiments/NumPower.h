@@ -13,6 +13,12 @@
 #include "raylib.h"
 
 class NumPower : public Experiment {
+	private:
+		// text of the last drawn best candidate (the program is transcribed and run only when the candidate changes)
+		std::vector<double> mDrawn_Candidate;
+		std::vector<std::string> mDrawn_Program;
+		std::vector<std::string> mDrawn_Outputs;
+
 	public:
 		NumPower() = default;
 		virtual ~NumPower() = default;
@@ -22,7 +28,7 @@ class NumPower : public Experiment {
 		bool On_Update(float delta_time) override;
 		bool On_Render() override;
 
-		void Draw_Candidate(const std::vector<double>& candidate, bool best = false) override;
+		void Draw_Candidate(const std::vector<double>& candidate, bool best = false, NDraw_Detail detail = NDraw_Detail::Full) override;
 		double Objective_Function(const std::vector<double>& parameters) override;
 		void Fill_Optimizer_Setup(TOptimizer_Setup& setup) override;
 		bool Check_Can_Optimize() override;
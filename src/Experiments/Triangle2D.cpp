@@ -13,9 +13,9 @@
 #include "../Core/Application.h"
 
 #include "../Optimizers/GeneticAlgorithm.h"
+#include "../Optimizers/FixedGeneticAlgorithm.h"
 
 #include <cmath>
-#include <format>
 
 bool Triangle2D::On_Init() {
 	mName = "Triangle 2D";
@@ -29,9 +29,7 @@ bool Triangle2D::On_Init() {
 }
 
 bool Triangle2D::On_Cleanup() {
-	if (mOptimization_Thread && mOptimization_Thread->joinable()) {
-		mOptimization_Thread->join();
-	}
+	Stop_Optimization();
 	return true;
 }
 
@@ -43,6 +41,27 @@ void Triangle2D::Reset_Data() {
 	Experiment::Reset_Data();
 }
 
+void Triangle2D::Save_Checkpoint_Data(TBinary_Writer& writer) const {
+	writer.Write<int32_t>(mLength_A);
+	writer.Write<int32_t>(mLength_B);
+	writer.Write<int32_t>(mLength_C);
+}
+
+bool Triangle2D::Load_Checkpoint_Data(TBinary_Reader& reader) {
+	int32_t lengths[3];
+	if (!reader.Read(lengths)) {
+		return false;
+	}
+	mLength_A = lengths[0];
+	mLength_B = lengths[1];
+	mLength_C = lengths[2];
+	// the inputs are parsed to the lengths on every frame
+	mInputStateA.text = std::to_string(mLength_A);
+	mInputStateB.text = std::to_string(mLength_B);
+	mInputStateC.text = std::to_string(mLength_C);
+	return true;
+}
+
 bool Triangle2D::On_Render() {
 
 	TSimple_Input inputA(400, 70, 100, 30, "A:", mInputStateA, NAppFont::RegularText, NInput_Mask::Numeric, 4);
@@ -92,7 +111,7 @@ bool Triangle2D::On_Render() {
 	if (mCandidates.size() > 0) {
 
 		std::unique_lock<std::mutex> lock(mCandidates_Mutex, std::defer_lock);
-		if (mIs_Optimizing) {
+		if (Is_Optimizing()) {
 			lock.lock();
 		}
 
@@ -105,7 +124,7 @@ bool Triangle2D::On_Render() {
 	return Experiment::On_Render();
 }
 
-void Triangle2D::Draw_Candidate(const std::vector<double>& candidate, bool best) {
+void Triangle2D::Draw_Candidate(const std::vector<double>& candidate, bool best, NDraw_Detail detail) {
 	if (candidate.size() == 6) {
 		const float x1 = static_cast<float>(candidate[0]);
 		const float y1 = static_cast<float>(candidate[1]);
@@ -125,15 +144,21 @@ void Triangle2D::Draw_Candidate(const std::vector<double>& candidate, bool best)
 			const float length_C = std::sqrtf((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
 
 			// draw lengths of sides at the middle of each side
-			DrawProxy::Text(std::format("{:.1f}", length_C), (int)((x1 + x2) / 2), (int)((y1 + y2) / 2) - 10, DARKGRAY, NAppFont::RegularText);
-			DrawProxy::Text(std::format("{:.1f}", length_B), (int)((x1 + x3) / 2), (int)((y1 + y3) / 2) - 10, DARKGRAY, NAppFont::RegularText);
-			DrawProxy::Text(std::format("{:.1f}", length_A), (int)((x2 + x3) / 2), (int)((y2 + y3) / 2) - 10, DARKGRAY, NAppFont::RegularText);
+			TText_Buffer length;
+			length.Append(length_C, 1);
+			DrawProxy::Text_Uncached(length.c_str(), (int)((x1 + x2) / 2), (int)((y1 + y2) / 2) - 10, DARKGRAY, NAppFont::RegularText);
+			length.Clear();
+			length.Append(length_B, 1);
+			DrawProxy::Text_Uncached(length.c_str(), (int)((x1 + x3) / 2), (int)((y1 + y3) / 2) - 10, DARKGRAY, NAppFont::RegularText);
+			length.Clear();
+			length.Append(length_A, 1);
+			DrawProxy::Text_Uncached(length.c_str(), (int)((x2 + x3) / 2), (int)((y2 + y3) / 2) - 10, DARKGRAY, NAppFont::RegularText);
 		}
 		else {
 			// other candidates
-			DrawLine(static_cast<int>(x1), static_cast<int>(y1), static_cast<int>(x2), static_cast<int>(y2), PINK);
-			DrawLine(static_cast<int>(x2), static_cast<int>(y2), static_cast<int>(x3), static_cast<int>(y3), PINK);
-			DrawLine(static_cast<int>(x3), static_cast<int>(y3), static_cast<int>(x1), static_cast<int>(y1), PINK);
+			mLine_Batch.Add({ x1, y1 }, { x2, y2 }, PINK);
+			mLine_Batch.Add({ x2, y2 }, { x3, y3 }, PINK);
+			mLine_Batch.Add({ x3, y3 }, { x1, y1 }, PINK);
 		}
 	}
 }
@@ -165,7 +190,10 @@ double Triangle2D::Objective_Function(const std::vector<double>& parameters) {
 	if (parameters.size() != 6) {
 		throw std::invalid_argument("Expected 6 parameters: x1, y1, x2, y2, x3, y3");
 	}
+	return Evaluate(std::span<const double, 6>(parameters.data(), 6));
+}
 
+double Triangle2D::Evaluate(std::span<const double, 6> parameters) const {
 	auto distance = [](float x1, float y1, float x2, float y2) {
 		return std::sqrtf((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
 	};
@@ -183,3 +211,9 @@ double Triangle2D::Objective_Function(const std::vector<double>& parameters) {
 
 	return (a - mLength_A) * (a - mLength_A) + (b - mLength_B) * (b - mLength_B) + (c - mLength_C) * (c - mLength_C);
 }
+
+std::unique_ptr<Optimizer> Triangle2D::Create_Fixed_Optimizer(double mutationRate, double crossoverRate) {
+	return Make_Fixed_Genetic_Algorithm<6>([this](const TFixed_Genome<6>& parameters) {
+		return Evaluate(parameters);
+	}, mutationRate, crossoverRate);
+}
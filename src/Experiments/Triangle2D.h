@@ -23,6 +23,14 @@ class Triangle2D : public Experiment {
 		TSimple_Input_State mInputStateB;
 		TSimple_Input_State mInputStateC;
 
+		// squared differences of the side lengths from the requested ones
+		double Evaluate(std::span<const double, 6> parameters) const;
+
+	protected:
+		void Save_Checkpoint_Data(TBinary_Writer& writer) const override;
+		bool Load_Checkpoint_Data(TBinary_Reader& reader) override;
+		std::unique_ptr<Optimizer> Create_Fixed_Optimizer(double mutationRate, double crossoverRate) override;
+
 	public:
 		Triangle2D() = default;
 		virtual ~Triangle2D() = default;
@@ -32,7 +40,7 @@ class Triangle2D : public Experiment {
 		bool On_Update(float delta_time) override;
 		bool On_Render() override;
 
-		void Draw_Candidate(const std::vector<double>& candidate, bool best = false) override;
+		void Draw_Candidate(const std::vector<double>& candidate, bool best = false, NDraw_Detail detail = NDraw_Detail::Full) override;
 		double Objective_Function(const std::vector<double>& parameters) override;
 		void Fill_Optimizer_Setup(TOptimizer_Setup& setup) override;
 		bool Check_Can_Optimize() override;
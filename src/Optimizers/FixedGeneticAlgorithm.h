@@ -0,0 +1,71 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include "GeneticAlgorithm.h"
+#include "../Core/PerfCounters.h"
+
+#include <array>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+// parameters of an experiment with a number of parameters known at compile time
+template <size_t N>
+using TFixed_Genome = std::array<double, N>;
+
+/**
+ * Front end of the genetic algorithm for experiments with a fixed number of parameters; the objective is a functor
+ * taking TFixed_Genome<N> and it is called directly (so it gets inlined), instead of through std::function, a virtual
+ * call and a size check per candidate
+ * The search itself is the generic GeneticAlgorithm - the front end installs a batch objective evaluating the candidates
+ * in a tight loop; it does not support mini-batch, multi-fidelity or surrogate evaluation (the objective is the full one)
+ */
+template <size_t N, typename TObjective>
+	requires std::is_invocable_r_v<double, const TObjective&, const TFixed_Genome<N>&>
+class FixedGeneticAlgorithm : public GeneticAlgorithm {
+	private:
+		TObjective mObjective;
+
+		static TFixed_Genome<N> To_Genome(const std::vector<double>& parameters) {
+			TFixed_Genome<N> genome;
+			std::copy_n(parameters.begin(), N, genome.begin());
+			return genome;
+		}
+
+	public:
+		FixedGeneticAlgorithm(TObjective objective, double mutationRate = 0.01, double crossoverRate = 0.7)
+			: GeneticAlgorithm(mutationRate, crossoverRate), mObjective(std::move(objective)) {}
+
+		void Optimize(const TOptimizer_Setup& setup, std::vector<double>& bestParameters, double& bestMetric) override {
+			// all the candidates have the size of the bounds, so the size is checked once here
+			if (setup.lowerBounds.size() != N) {
+				throw std::invalid_argument("Invalid optimizer setup");
+			}
+
+			TOptimizer_Setup fixedSetup = setup;
+			fixedSetup.objectiveFunction = [this](const std::vector<double>& parameters) {
+				TPerf_Scope evaluationScope(NPerf_Counter::Evaluation);
+				return mObjective(To_Genome(parameters));
+			};
+			fixedSetup.batchObjectiveFunction = [this](std::span<const std::vector<double>> candidates, std::span<double> values) {
+				TPerf_Scope evaluationScope(NPerf_Counter::Evaluation, candidates.size());
+				for (size_t i = 0; i < candidates.size(); i++) {
+					values[i] = mObjective(To_Genome(candidates[i]));
+				}
+			};
+
+			GeneticAlgorithm::Optimize(fixedSetup, bestParameters, bestMetric);
+		}
+};
+
+template <size_t N, typename TObjective>
+std::unique_ptr<Optimizer> Make_Fixed_Genetic_Algorithm(TObjective objective, double mutationRate, double crossoverRate) {
+	return std::make_unique<FixedGeneticAlgorithm<N, TObjective>>(std::move(objective), mutationRate, crossoverRate);
+}
@@ -6,12 +6,23 @@
  */
 
 #include "GeneticAlgorithm.h"
+#include "../Core/PerfCounters.h"
+#include "../Core/Trace.h"
+#include "../Core/ThreadPool.h"
 
 #include <random>
 #include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <chrono>
+#include <bit>
+#include <cstring>
+
+namespace {
+	// smallest batch worth splitting the population for
+	constexpr size_t Min_Batch_Size = 8;
+}
 
 size_t GeneticAlgorithm::Select_Random_Parent(const TOptimizer_Setup& setup, size_t topCount) {
 	std::uniform_int_distribution<> dis(0, (int)topCount - 1);
@@ -33,29 +44,54 @@ void GeneticAlgorithm::Crossover(const TOptimizer_Setup& setup, size_t parentA,
 				mPopulation_Next[targetIdx][i] = mPopulation[parentB][i];
 			}
 		}
+
+		// the parents may share the genes behind the cross point (e.g., copies of the same elite)
+		if (Is_Bit_Identical(mPopulation_Next[targetIdx], mPopulation[parentA])) {
+			Inherit_Objective_Value(parentA, targetIdx);
+		}
+		else if (Is_Bit_Identical(mPopulation_Next[targetIdx], mPopulation[parentB])) {
+			Inherit_Objective_Value(parentB, targetIdx);
+		}
+		else {
+			mPopulation_Next_Dirty[targetIdx] = 1;
+		}
 	}
 	else {
 		// No crossover, copy parent A
 		mPopulation_Next[targetIdx] = mPopulation[parentA];
+		Inherit_Objective_Value(parentA, targetIdx);
 	}
 }
 
 void GeneticAlgorithm::Mutate(const TOptimizer_Setup& setup, size_t targetIdx) {
-	std::uniform_real_distribution<> dis(0.0, 1.0);
-	for (size_t i = 0; i < mPopulation_Next[targetIdx].size(); ++i) {
-		if (dis(mRandGen) < mMutationRate) {
+	auto& genome = mPopulation_Next[targetIdx];
 
-			const double mutAmount = mMutation_Distributions[i](mRandGen);
-			mPopulation_Next[targetIdx][i] += mutAmount;
+	// mMutation_Skip counts the genes to skip, the count continues to the following individuals
+	while (mMutation_Skip < genome.size()) {
+		const size_t i = mMutation_Skip;
+		const double original = genome[i];
 
-			// Ensure within bounds
-			if (mPopulation_Next[targetIdx][i] < setup.lowerBounds[i]) {
-				mPopulation_Next[targetIdx][i] = setup.lowerBounds[i];
-			}
-			else if (mPopulation_Next[targetIdx][i] > setup.upperBounds[i]) {
-				mPopulation_Next[targetIdx][i] = setup.upperBounds[i];
-			}
+		genome[i] += mGaussian.Next(mRandGen) * mMutation_Sigma[i];
+
+		// Ensure within bounds
+		if (genome[i] < setup.lowerBounds[i]) {
+			genome[i] = setup.lowerBounds[i];
+		}
+		else if (genome[i] > setup.upperBounds[i]) {
+			genome[i] = setup.upperBounds[i];
 		}
+
+		// clamping may bring the gene back to its original value
+		if (std::bit_cast<uint64_t>(genome[i]) != std::bit_cast<uint64_t>(original)) {
+			mPopulation_Next_Dirty[targetIdx] = 1;
+		}
+
+		const size_t skip = mMutation_Skip_Sampler.Next(mRandGen);
+		mMutation_Skip = (skip >= std::numeric_limits<size_t>::max() - i - 1) ? std::numeric_limits<size_t>::max() : i + 1 + skip;
+	}
+
+	if (mMutation_Skip != std::numeric_limits<size_t>::max()) {
+		mMutation_Skip -= genome.size();
 	}
 }
 
@@ -64,16 +100,236 @@ void GeneticAlgorithm::Generate_Random_Individual(const TOptimizer_Setup& setup,
 	for (size_t i = 0; i < setup.lowerBounds.size(); ++i) {
 		mPopulation_Next[popNextIdx][i] = setup.lowerBounds[i] + dis(mRandGen) * (setup.upperBounds[i] - setup.lowerBounds[i]);
 	}
+	mPopulation_Next_Dirty[popNextIdx] = 1;
+}
+
+bool GeneticAlgorithm::Is_Bit_Identical(const std::vector<double>& a, const std::vector<double>& b) {
+	return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+}
+
+void GeneticAlgorithm::Inherit_Objective_Value(size_t parentIdx, size_t targetIdx) {
+	// a coarse estimate would pass for a full fidelity value in the next generation - the offspring is evaluated on its own
+	if (parentIdx < mCoarse_Only.size() && mCoarse_Only[parentIdx]) {
+		mPopulation_Next_Dirty[targetIdx] = 1;
+		return;
+	}
+
+	mObjectiveValues_Next[targetIdx] = mObjectiveValues[parentIdx];
+	mPopulation_Next_Dirty[targetIdx] = 0;
+}
+
+bool GeneticAlgorithm::Data_Changed(const TOptimizer_Setup& setup) {
+	if (!setup.dataRevisionFunction) {
+		return false;
+	}
+
+	const uint64_t revision = setup.dataRevisionFunction();
+	if (revision == mData_Revision) {
+		return false;
+	}
+	mData_Revision = revision;
+	return true;
 }
 
 void GeneticAlgorithm::Evaluate_Population(const TOptimizer_Setup& setup) {
+	TRACE_SCOPE("GA::Evaluation");
+
+	// the inherited values were measured on a different subset in mini-batch mode
+	const bool evaluateAll = Is_Mini_Batch(setup);
+
+	mEvaluations += evaluateAll ? mPopulation.size() : static_cast<size_t>(std::count(mPopulation_Dirty.begin(), mPopulation_Dirty.end(), 1));
+
+	if (setup.batchObjectiveFunction) {
+		Evaluate_Population_Batch(setup, evaluateAll);
+		return;
+	}
+
+	if (Is_Multi_Fidelity(setup)) {
+		mBatch_Indices.clear();
+		for (size_t i = 0; i < mPopulation.size(); ++i) {
+			if (mPopulation_Dirty[i]) {
+				mBatch_Indices.push_back(i);
+			}
+		}
+		mEvaluations += Evaluate_Multi_Fidelity(setup, mBatch_Indices, mBatch_Values);
+		return;
+	}
+
+	auto evaluateRange = [this, &setup, evaluateAll](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			if (evaluateAll || mPopulation_Dirty[i]) {
+				mObjectiveValues[i] = setup.objectiveFunction(mPopulation[i]);
+			}
+		}
+	};
+
+	if (setup.parallelEvaluation) {
+		ThreadPool::Instance().Parallel_For(mPopulation.size(), evaluateRange);
+		return;
+	}
+
+	evaluateRange(0, mPopulation.size());
+}
+
+void GeneticAlgorithm::Evaluate_Population_Batch(const TOptimizer_Setup& setup, bool evaluateAll) {
+	mBatch_Indices.clear();
 	for (size_t i = 0; i < mPopulation.size(); ++i) {
-		mObjectiveValues[i] = setup.objectiveFunction(mPopulation[i]);
+		if (evaluateAll || mPopulation_Dirty[i]) {
+			mBatch_Indices.push_back(i);
+		}
+	}
+
+	const size_t count = mBatch_Indices.size();
+	if (count == 0) {
+		return;
+	}
+
+	// the candidates are small, copying them keeps the batch contiguous (and reuses the allocations)
+	mBatch_Candidates.resize(count);
+	mBatch_Values.resize(count);
+	for (size_t k = 0; k < count; ++k) {
+		mBatch_Candidates[k] = mPopulation[mBatch_Indices[k]];
+	}
+
+	auto evaluateBatch = [this, &setup](size_t begin, size_t end) {
+		setup.batchObjectiveFunction(std::span<const std::vector<double>>(mBatch_Candidates).subspan(begin, end - begin), std::span<double>(mBatch_Values).subspan(begin, end - begin));
+	};
+
+	if (setup.parallelEvaluation) {
+		// larger batches amortize the data pass better than the pool's load balancing chunks would
+		const size_t batchCount = std::min(ThreadPool::Instance().Concurrency(), (count + Min_Batch_Size - 1) / Min_Batch_Size);
+		ThreadPool::Instance().Parallel_For(batchCount, [count, batchCount, &evaluateBatch](size_t begin, size_t end) {
+			for (size_t b = begin; b < end; ++b) {
+				evaluateBatch(count * b / batchCount, count * (b + 1) / batchCount);
+			}
+		});
+	}
+	else {
+		evaluateBatch(0, count);
+	}
+
+	for (size_t k = 0; k < count; ++k) {
+		mObjectiveValues[mBatch_Indices[k]] = mBatch_Values[k];
+	}
+}
+
+void GeneticAlgorithm::Resample_Subset(const TOptimizer_Setup& setup) {
+	setup.subsetFunction(mMiniBatch_Size, mRandGen());
+}
+
+void GeneticAlgorithm::Update_Best_Mini_Batch(const TOptimizer_Setup& setup, const std::vector<double>& candidate, size_t iteration) {
+	const size_t interval = std::max<size_t>(1, setup.miniBatchEliteInterval);
+	if (iteration % interval != 0 && !mBest.empty()) {
+		return;
+	}
+
+	// subset values are noisy estimates, only the full data value may replace the best solution
+	setup.subsetFunction(0, 0);
+	const double fullMetric = setup.objectiveFunction(candidate);
+	mEvaluations++;
+
+	if (fullMetric < mBestMetric) {
+		mBestMetric = fullMetric;
+		mBest = candidate;
+		mMiniBatch_Stall = 0;
+	}
+	else {
+		mMiniBatch_Stall += interval;
+	}
+
+	// no improvement for a while - the noise of the subset estimate dominates, grow the subset
+	if (mMiniBatch_Stall >= setup.miniBatchGrowthPatience && mMiniBatch_Size < setup.miniBatchMaxSize) {
+		mMiniBatch_Size = std::min(setup.miniBatchMaxSize, static_cast<size_t>(static_cast<double>(mMiniBatch_Size) * std::max(1.0, setup.miniBatchGrowthFactor)) + 1);
+		mMiniBatch_Stall = 0;
 	}
 }
 
 void GeneticAlgorithm::Apply_Population_Next() {
 	mPopulation = mPopulation_Next;
+	mObjectiveValues = mObjectiveValues_Next;
+	mPopulation_Dirty = mPopulation_Next_Dirty;
+}
+
+void GeneticAlgorithm::Resize_Population(size_t populationSize, size_t paramCount) {
+	mPopulation.resize(populationSize, std::vector<double>(paramCount));
+	mPopulation_Next.resize(populationSize, std::vector<double>(paramCount));
+
+	mObjectiveValues.resize(populationSize);
+	mObjectiveValues_Next.resize(populationSize);
+	mPopulation_Next_Dirty.assign(populationSize, 1);
+}
+
+void GeneticAlgorithm::Restart_Population(const TOptimizer_Setup& setup, size_t populationSize) {
+	TRACE_SCOPE("GA::Restart");
+
+	Resize_Population(populationSize, setup.lowerBounds.size());
+	for (size_t i = 0; i < populationSize; ++i) {
+		Generate_Random_Individual(setup, i);
+	}
+	Apply_Population_Next();
+
+	// the best solution found so far survives the restart
+	if (!mBest.empty()) {
+		mPopulation[0] = mBest;
+	}
+
+	Evaluate_Population(setup);
+}
+
+void GeneticAlgorithm::Save_State(TBinary_Writer& writer, size_t nextIteration) const {
+	Save_Base_State(writer);
+
+	mGaussian.Save(writer);
+
+	writer.Write_Span<double>(mBest);
+	writer.Write(mBestMetric);
+	writer.Write<uint64_t>(mMiniBatch_Size);
+	writer.Write<uint64_t>(mMiniBatch_Stall);
+	writer.Write<uint64_t>(nextIteration);
+
+	mStagnation.Save(writer);
+	writer.Write<uint64_t>(mEvaluations);
+}
+
+bool GeneticAlgorithm::Load_State(const TOptimizer_Setup& setup, size_t& nextIteration) {
+	TBinary_Reader reader(setup.resumeState);
+
+	const size_t paramCount = setup.lowerBounds.size();
+	// the population only grows (on restarts)
+	if (!Load_Base_State(reader, paramCount) || mPopulation.size() < setup.populationSize) {
+		return false;
+	}
+
+	if (!mGaussian.Load(reader)) {
+		return false;
+	}
+
+	uint64_t miniBatchSize = 0, miniBatchStall = 0, iteration = 0, evaluations = 0;
+	if (!reader.Read_Vector(mBest) || !reader.Read(mBestMetric) || !reader.Read(miniBatchSize) || !reader.Read(miniBatchStall) || !reader.Read(iteration) || !mStagnation.Load(reader) || !reader.Read(evaluations)) {
+		return false;
+	}
+	if (!mBest.empty() && mBest.size() != paramCount) {
+		return false;
+	}
+
+	mMiniBatch_Size = static_cast<size_t>(miniBatchSize);
+	mMiniBatch_Stall = static_cast<size_t>(miniBatchStall);
+	nextIteration = static_cast<size_t>(iteration);
+	mEvaluations = static_cast<size_t>(evaluations);
+
+	return reader.At_End();
+}
+
+void GeneticAlgorithm::Emit_Checkpoint(const TOptimizer_Setup& setup, size_t nextIteration) const {
+	if (!setup.checkpointFunction) {
+		return;
+	}
+
+	TRACE_SCOPE("GA::Checkpoint");
+
+	TBinary_Writer writer;
+	Save_State(writer, nextIteration);
+	setup.checkpointFunction(writer.Take());
 }
 
 void GeneticAlgorithm::Optimize(const TOptimizer_Setup& setup, std::vector<double>& bestParameters, double& bestMetric) {
@@ -81,57 +337,132 @@ void GeneticAlgorithm::Optimize(const TOptimizer_Setup& setup, std::vector<doubl
 		throw std::invalid_argument("Invalid optimizer setup");
 	}
 
-	// Prepare mutation distributions; sensitivity is not mandatory, fall back to 10.0
-	mMutation_Distributions.clear();
+	// Prepare mutation dispersions; sensitivity is not mandatory, fall back to 10.0
+	mMutation_Sigma.clear();
 	for (size_t i = 0; i < setup.lowerBounds.size(); ++i) {
 		double sensitivity = 10.0;
 		if (i < setup.sensitivity.size() && setup.sensitivity[i] > 0.0) {
 			sensitivity = setup.sensitivity[i];
 		}
-		mMutation_Distributions.emplace_back(0.0, sensitivity);
+		mMutation_Sigma.push_back(sensitivity);
 	}
+	mMutation_Skip_Sampler.Set_Probability(mMutationRate);
 
 	const size_t paramCount = setup.lowerBounds.size();
-	mPopulation.resize(setup.populationSize, std::vector<double>(paramCount));
-	mPopulation_Next.resize(setup.populationSize, std::vector<double>(paramCount));
+	Resize_Population(setup.populationSize, paramCount);
+	mStagnation = {};
+	mEvaluations = 0;
+	mCoarse_Only.clear();
 
-	mObjectiveValues.resize(setup.populationSize);
-	// Initialize population
-	for (size_t i = 0; i < setup.populationSize; ++i) {
-		Generate_Random_Individual(setup, i);
+	const bool miniBatch = Is_Mini_Batch(setup);
+	size_t firstIteration = 0;
+
+	// the initial (or resumed) objective values are measured on the current data
+	Data_Changed(setup);
+
+	bestMetric = std::numeric_limits<double>::infinity();
+	bestParameters.clear();
+
+	if (!setup.resumeState.empty()) {
+		if (!Load_State(setup, firstIteration)) {
+			throw std::invalid_argument("Invalid optimizer state to resume from");
+		}
+		Resize_Population(mPopulation.size(), paramCount);
+
+		// the experiment data are stored when the optimization starts, the checkpointed values may have been measured
+		// on data edited later - everything is re-evaluated on the loaded data
+		if (!mBest.empty()) {
+			if (miniBatch) {
+				setup.subsetFunction(0, 0);
+			}
+			mBestMetric = setup.objectiveFunction(mBest);
+			mEvaluations++;
+		}
+		if (miniBatch) {
+			Resample_Subset(setup);
+		}
+		mPopulation_Dirty.assign(mPopulation.size(), 1);
+		Evaluate_Population(setup);
+
+		// the best solution found so far is tracked in mBest in both modes
+		if (!mBest.empty()) {
+			bestMetric = mBestMetric;
+			bestParameters = mBest;
+		}
 	}
+	else {
+		// Initialize population
+		for (size_t i = 0; i < setup.populationSize; ++i) {
+			Generate_Random_Individual(setup, i);
+		}
 
-	Apply_Population_Next();
+		Apply_Population_Next();
 
-	if (!setup.initialGuess.empty() && setup.initialGuess.size() == paramCount) {
-		// Replace the first individual with the initial guess
-		mPopulation[0] = setup.initialGuess;
+		if (!setup.initialGuess.empty() && setup.initialGuess.size() == paramCount) {
+			// Replace the first individual with the initial guess
+			mPopulation[0] = setup.initialGuess;
+		}
+
+		if (miniBatch) {
+			mMiniBatch_Size = setup.miniBatchMinSize;
+			mMiniBatch_Stall = 0;
+			mBest.clear();
+			mBestMetric = std::numeric_limits<double>::infinity();
+			Resample_Subset(setup);
+		}
+
+		Evaluate_Population(setup);
 	}
 
-	Evaluate_Population(setup);
-	bestMetric = std::numeric_limits<double>::infinity();
-	bestParameters.clear();
 	if (setup.callbackFunction) {
-		if (setup.callbackFunction(NCallback_Stage::Before, 0, 0, mPopulation) == NAction::Abort) {
+		if (setup.callbackFunction(NCallback_Stage::Before, firstIteration, 0, mPopulation) == NAction::Abort) {
 			return;
 		}
 	}
 
-	for (size_t iter = 0; iter < setup.maxIterations; ++iter) {
+	TCallback_Gate callbackGate(setup);
+	const TBudget budget(setup);
 
-		// Sort population by objective values (ascending)
-		std::vector<size_t> indices(setup.populationSize);
-		
-		for (size_t i = 0; i < setup.populationSize; ++i) {
-			indices[i] = i;
+	auto lastCheckpoint = std::chrono::steady_clock::now();
+
+	for (size_t iter = firstIteration; iter < setup.maxIterations; ++iter) {
+
+		if (setup.stopToken.stop_requested()) {
+			Emit_Checkpoint(setup, iter);
+			break;
 		}
 
-		std::sort(indices.begin(), indices.end(), [this](size_t a, size_t b) {
-			return mObjectiveValues[a] < mObjectiveValues[b];
-		});
+		TPerf_Scope generationScope(NPerf_Counter::Generation);
+
+		TRACE_SCOPE("GA::Generation");
+
+		// changes on restarts
+		const size_t popSize = mPopulation.size();
+
+		// Sort population by objective values (ascending)
+		std::vector<size_t> indices(popSize);
+		{
+			TRACE_SCOPE("GA::Sorting");
+
+			for (size_t i = 0; i < popSize; ++i) {
+				indices[i] = i;
+			}
+
+			std::sort(indices.begin(), indices.end(), [this](size_t a, size_t b) {
+				return mObjectiveValues[a] < mObjectiveValues[b];
+			});
+		}
 
 		// Update best found solution
-		if (mObjectiveValues[indices[0]] < bestMetric) {
+		if (miniBatch) {
+			Update_Best_Mini_Batch(setup, mPopulation[indices[0]], iter);
+			bestMetric = mBestMetric;
+			bestParameters = mBest;
+
+			// the next population is evaluated on a fresh subset
+			Resample_Subset(setup);
+		}
+		else if (mObjectiveValues[indices[0]] < bestMetric) {
 			bestMetric = mObjectiveValues[indices[0]];
 			bestParameters = mPopulation[indices[0]];
 
@@ -141,53 +472,100 @@ void GeneticAlgorithm::Optimize(const TOptimizer_Setup& setup, std::vector<doubl
 			}
 		}
 
-		size_t topCount = setup.populationSize / 2;
+		size_t topCount = popSize / 2;
 		// Create next generation
-		for (size_t i = 0; i < setup.populationSize; ++i) {
-			size_t parentA = Select_Random_Parent(setup, topCount);
-			size_t parentB = Select_Random_Parent(setup, topCount);
-			Crossover(setup, indices[parentA], indices[parentB], i);
-			Mutate(setup, i);
-			// With small probability, generate a completely random individual
-			std::uniform_real_distribution<> dis(0.0, 1.0);
-			if (dis(mRandGen) < 0.05) {
-				Generate_Random_Individual(setup, i);
+		{
+			TRACE_SCOPE("GA::Breeding");
+
+			// the mutation skip count continues across the individuals of the generation
+			mMutation_Skip = mMutation_Skip_Sampler.Next(mRandGen);
+			for (size_t i = 0; i < popSize; ++i) {
+				size_t parentA = Select_Random_Parent(setup, topCount);
+				size_t parentB = Select_Random_Parent(setup, topCount);
+				Crossover(setup, indices[parentA], indices[parentB], i);
+				Mutate(setup, i);
+				// With small probability, generate a completely random individual
+				std::uniform_real_distribution<> dis(0.0, 1.0);
+				if (dis(mRandGen) < 0.05) {
+					Generate_Random_Individual(setup, i);
+				}
 			}
 		}
 
 		Apply_Population_Next();
+
+		// the inherited objective values and the best metric were measured on the old data
+		if (Data_Changed(setup)) {
+			std::fill(mPopulation_Dirty.begin(), mPopulation_Dirty.end(), 1);
+			mBestMetric = std::numeric_limits<double>::infinity();
+			bestMetric = mBestMetric;
+		}
+
 		Evaluate_Population(setup);
 
-		// sort the population vector by the objective values
-		std::sort(indices.begin(), indices.end(), [this](size_t a, size_t b) {
-			return mObjectiveValues[a] < mObjectiveValues[b];
-		});
+		{
+			TRACE_SCOPE("GA::Sorting");
 
-		// select the worst parameters and replace them with the mBest
-		mPopulation[*indices.rbegin()] = mBest;
-		mObjectiveValues[*indices.rbegin()] = setup.objectiveFunction(mBest); // re-evaluate the best as the data may have changed
+			// sort the population vector by the objective values
+			std::sort(indices.begin(), indices.end(), [this](size_t a, size_t b) {
+				return mObjectiveValues[a] < mObjectiveValues[b];
+			});
 
-		// sort the population vector by the objective values
-		std::sort(indices.begin(), indices.end(), [this](size_t a, size_t b) {
-			return mObjectiveValues[a] < mObjectiveValues[b];
-		});
+			// select the worst parameters and replace them with the mBest
+			mPopulation[*indices.rbegin()] = mBest;
+			mObjectiveValues[*indices.rbegin()] = setup.objectiveFunction(mBest); // re-evaluate the best as the data may have changed
+			mEvaluations++;
+			if (!mCoarse_Only.empty()) {
+				mCoarse_Only[*indices.rbegin()] = 0;
+			}
 
-		// sort the mPopulation vector by the objective values
-		std::vector<std::vector<double>> sortedPopulation(setup.populationSize);
-		for (size_t i = 0; i < setup.populationSize; ++i) {
-			sortedPopulation[i] = mPopulation[indices[i]];
+			// sort the population vector by the objective values
+			std::sort(indices.begin(), indices.end(), [this](size_t a, size_t b) {
+				return mObjectiveValues[a] < mObjectiveValues[b];
+			});
 		}
 
-		if (setup.callbackFunction) {
-			if (setup.callbackFunction(NCallback_Stage::After, iter, mObjectiveValues[indices[0]], sortedPopulation) == NAction::Abort) {
+		generationScope.Stop();
+
+		// in mini-batch mode, only the full data metric is meaningful
+		const double reportedMetric = miniBatch ? mBestMetric : mObjectiveValues[indices[0]];
+
+		const NStagnation_Action stagnation = mStagnation.Update(setup, reportedMetric, mPopulation);
+		const bool stopping = (stagnation == NStagnation_Action::Stop) || budget.Exhausted(mEvaluations, reportedMetric);
+
+		// the sorted population is built only for the callback, so skip it when the callback is not delivered;
+		// the final state is always delivered when stopping early
+		if (callbackGate.Should_Deliver(iter, reportedMetric) || (stopping && setup.callbackFunction)) {
+			TPerf_Scope callbackScope(NPerf_Counter::Callback);
+
+			// sort the mPopulation vector by the objective values
+			std::vector<std::vector<double>> sortedPopulation(popSize);
+			for (size_t i = 0; i < popSize; ++i) {
+				sortedPopulation[i] = mPopulation[indices[i]];
+			}
+
+			if (setup.callbackFunction(NCallback_Stage::After, iter, reportedMetric, sortedPopulation) == NAction::Abort) {
+				Emit_Checkpoint(setup, iter + 1);
 				break;
 			}
 		}
+
+		if (stopping) {
+			break;
+		}
+		if (stagnation == NStagnation_Action::Restart) {
+			Restart_Population(setup, TStagnation_Detector::Restart_Population_Size(setup, popSize));
+		}
+
+		if (setup.checkpointFunction && std::chrono::steady_clock::now() - lastCheckpoint >= setup.checkpointInterval) {
+			Emit_Checkpoint(setup, iter + 1);
+			lastCheckpoint = std::chrono::steady_clock::now();
+		}
 	}
 
 	// sort population one last time to get the best solution
-	std::vector<size_t> indices(setup.populationSize);
-	for (size_t i = 0; i < setup.populationSize; ++i) {
+	std::vector<size_t> indices(mPopulation.size());
+	for (size_t i = 0; i < mPopulation.size(); ++i) {
 		indices[i] = i;
 	}
 	std::sort(indices.begin(), indices.end(), [this](size_t a, size_t b) {
@@ -195,4 +573,13 @@ void GeneticAlgorithm::Optimize(const TOptimizer_Setup& setup, std::vector<doubl
 	});
 	bestMetric = mObjectiveValues[indices[0]];
 	bestParameters = mPopulation[indices[0]];
+
+	if (miniBatch) {
+		// leave the objective on the full data and return the best full data solution
+		setup.subsetFunction(0, 0);
+		if (!mBest.empty()) {
+			bestMetric = mBestMetric;
+			bestParameters = mBest;
+		}
+	}
 }
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "../Core/Optimizer.h"
+#include "../Core/Sampling.h"
 
 #include <random>
 
@@ -16,11 +17,52 @@ class GeneticAlgorithm : public Optimizer {
 		double mMutationRate = 0.01; // Probability of mutation
 		double mCrossoverRate = 0.7; // Probability of crossover
 
-		std::vector<std::normal_distribution<double>> mMutation_Distributions;
+		// mutation dispersion of each parameter
+		std::vector<double> mMutation_Sigma;
+		// mutation is sparse - the sampler jumps over the unmutated genes (across individuals) instead of testing each gene
+		Sampling::TGeometric_Skip mMutation_Skip_Sampler;
+		// genes left to skip before the next mutated one (within the current generation)
+		size_t mMutation_Skip = 0;
+		Sampling::TGaussian_Batch mGaussian;
+
+		// fitness inheritance: an individual bit-identical to its parent takes over the parent's objective value
+		// objective values inherited by the next population (valid where mPopulation_Next_Dirty is 0)
+		std::vector<double> mObjectiveValues_Next;
+		// 1 = the individual differs from its parents and needs to be evaluated
+		std::vector<uint8_t> mPopulation_Next_Dirty;
+		std::vector<uint8_t> mPopulation_Dirty;
+		// data revision the objective values were measured on (see TOptimizer_Setup::dataRevisionFunction)
+		uint64_t mData_Revision = 0;
+
+		// compacted individuals (and their values) for the batch objective function
+		std::vector<size_t> mBatch_Indices;
+		std::vector<std::vector<double>> mBatch_Candidates;
+		std::vector<double> mBatch_Values;
 
 		std::vector<double> mBest;
 		double mBestMetric = std::numeric_limits<double>::infinity();
 
+		TStagnation_Detector mStagnation;
+		// objective function evaluations so far (for the evaluation budget)
+		size_t mEvaluations = 0;
+
+		// mini-batch state
+		size_t mMiniBatch_Size = 0;
+		size_t mMiniBatch_Stall = 0;
+
+		bool Is_Mini_Batch(const TOptimizer_Setup& setup) const {
+			return setup.subsetFunction && setup.miniBatchMinSize > 0;
+		}
+
+		bool Is_Multi_Fidelity(const TOptimizer_Setup& setup) const {
+			return setup.coarseObjectiveFunction && !setup.batchObjectiveFunction && !Is_Mini_Batch(setup);
+		}
+
+		// draws a new data subset for the following evaluations
+		void Resample_Subset(const TOptimizer_Setup& setup);
+		// re-evaluates the candidate on the full data (periodically), updates the best solution and grows the subset on stagnation
+		void Update_Best_Mini_Batch(const TOptimizer_Setup& setup, const std::vector<double>& candidate, size_t iteration);
+
 		size_t Select_Random_Parent(const TOptimizer_Setup& setup, size_t topCount);
 
 		void Crossover(const TOptimizer_Setup& setup, size_t parentA, size_t parentB, size_t targetIdx);
@@ -28,10 +70,31 @@ class GeneticAlgorithm : public Optimizer {
 
 		void Generate_Random_Individual(const TOptimizer_Setup& setup, size_t popNextIdx);
 
+		static bool Is_Bit_Identical(const std::vector<double>& a, const std::vector<double>& b);
+		// the next population individual takes over the objective value of its parent
+		void Inherit_Objective_Value(size_t parentIdx, size_t targetIdx);
+		// checks the data revision; returns true if the data changed since the last check
+		bool Data_Changed(const TOptimizer_Setup& setup);
+
+		// evaluates the dirty individuals (all of them in mini-batch mode, as the subset changes every generation)
 		void Evaluate_Population(const TOptimizer_Setup& setup);
+		// evaluates the given individuals through the batch objective function, split to one batch per thread
+		void Evaluate_Population_Batch(const TOptimizer_Setup& setup, bool evaluateAll);
 
 		void Apply_Population_Next();
 
+		// resize the population buffers (the content of the new individuals is undefined)
+		void Resize_Population(size_t populationSize, size_t paramCount);
+		// replace the population with a new random one of the given size, keeping the best solution found so far
+		void Restart_Population(const TOptimizer_Setup& setup, size_t populationSize);
+
+		// store the complete state needed to continue with the given iteration
+		void Save_State(TBinary_Writer& writer, size_t nextIteration) const;
+		// restore the state stored by Save_State (the setup must match), returns false if the state is invalid
+		bool Load_State(const TOptimizer_Setup& setup, size_t& nextIteration);
+		// serialize the state and pass it to the setup checkpoint function (if any)
+		void Emit_Checkpoint(const TOptimizer_Setup& setup, size_t nextIteration) const;
+
 	public:
 		GeneticAlgorithm(double mutationRate = 0.01, double crossoverRate = 0.7)
 			: mMutationRate(mutationRate), mCrossoverRate(crossoverRate) {}
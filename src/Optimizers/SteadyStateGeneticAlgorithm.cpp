@@ -0,0 +1,424 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#include "SteadyStateGeneticAlgorithm.h"
+#include "../Core/PerfCounters.h"
+#include "../Core/ThreadPool.h"
+#include "../Core/Trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+	constexpr size_t Tournament_Size = 3;
+	// probability of a completely random offspring
+	constexpr double Random_Immigrant_Rate = 0.05;
+}
+
+size_t SteadyStateGeneticAlgorithm::Select_Parent() {
+	std::uniform_int_distribution<size_t> dis(0, mPopulation.size() - 1);
+
+	size_t best = dis(mRandGen);
+	for (size_t i = 1; i < Tournament_Size; i++) {
+		const size_t candidate = dis(mRandGen);
+		if (mObjectiveValues[candidate] < mObjectiveValues[best]) {
+			best = candidate;
+		}
+	}
+	return best;
+}
+
+void SteadyStateGeneticAlgorithm::Mutate(const TOptimizer_Setup& setup, std::vector<double>& offspring, bool& changed) {
+	while (mMutation_Skip < offspring.size()) {
+		const size_t i = mMutation_Skip;
+		const double original = offspring[i];
+
+		offspring[i] = std::clamp(offspring[i] + mGaussian.Next(mRandGen) * mMutation_Sigma[i], setup.lowerBounds[i], setup.upperBounds[i]);
+		if (std::memcmp(&offspring[i], &original, sizeof(double)) != 0) {
+			changed = true;
+		}
+
+		const size_t skip = mMutation_Skip_Sampler.Next(mRandGen);
+		mMutation_Skip = (skip >= std::numeric_limits<size_t>::max() - i - 1) ? std::numeric_limits<size_t>::max() : i + 1 + skip;
+	}
+
+	if (mMutation_Skip != std::numeric_limits<size_t>::max()) {
+		mMutation_Skip -= offspring.size();
+	}
+}
+
+bool SteadyStateGeneticAlgorithm::Breed(const TOptimizer_Setup& setup, std::vector<double>& offspring) {
+	std::uniform_real_distribution<> dis(0.0, 1.0);
+
+	if (dis(mRandGen) < Random_Immigrant_Rate) {
+		for (size_t i = 0; i < offspring.size(); ++i) {
+			offspring[i] = setup.lowerBounds[i] + dis(mRandGen) * (setup.upperBounds[i] - setup.lowerBounds[i]);
+		}
+		return true;
+	}
+
+	const size_t parentA = Select_Parent();
+	offspring = mPopulation[parentA];
+
+	bool changed = false;
+	if (offspring.size() > 1 && dis(mRandGen) < mCrossoverRate) {
+		const size_t parentB = Select_Parent();
+
+		// single-point crossover
+		std::uniform_int_distribution<size_t> crossPointDis(1, offspring.size() - 1);
+		const size_t crossPoint = crossPointDis(mRandGen);
+		for (size_t i = crossPoint; i < offspring.size(); ++i) {
+			offspring[i] = mPopulation[parentB][i];
+		}
+		changed = std::memcmp(offspring.data(), mPopulation[parentA].data(), offspring.size() * sizeof(double)) != 0;
+	}
+
+	Mutate(setup, offspring, changed);
+
+	// a copy of its parent brings no new information, and would only reduce the diversity
+	return changed;
+}
+
+void SteadyStateGeneticAlgorithm::Insert(const std::vector<double>& offspring, double value, bool coarseOnly) {
+	const auto worst = std::max_element(mObjectiveValues.begin(), mObjectiveValues.end());
+	if (worst == mObjectiveValues.end() || !(value < *worst)) {
+		return;
+	}
+
+	const size_t worstIdx = static_cast<size_t>(std::distance(mObjectiveValues.begin(), worst));
+	mPopulation[worstIdx] = offspring;
+	mObjectiveValues[worstIdx] = value;
+	if (!mCoarse_Only.empty()) {
+		mCoarse_Only[worstIdx] = coarseOnly ? 1 : 0;
+	}
+
+	if (value < mBestMetric) {
+		mBestMetric = value;
+		mBest = offspring;
+	}
+}
+
+bool SteadyStateGeneticAlgorithm::Data_Changed(const TOptimizer_Setup& setup) {
+	if (!setup.dataRevisionFunction) {
+		return false;
+	}
+
+	const uint64_t revision = setup.dataRevisionFunction();
+	if (revision == mData_Revision) {
+		return false;
+	}
+	mData_Revision = revision;
+	return true;
+}
+
+void SteadyStateGeneticAlgorithm::Evaluate_Population(const TOptimizer_Setup& setup) {
+	TRACE_SCOPE("SSGA::Population_Evaluation");
+
+	if (setup.coarseObjectiveFunction) {
+		mPromoted.resize(mPopulation.size());
+		for (size_t i = 0; i < mPromoted.size(); ++i) {
+			mPromoted[i] = i;
+		}
+		Evaluate_Multi_Fidelity(setup, mPromoted, mPromotion_Scratch);
+		return;
+	}
+
+	auto evaluateRange = [this, &setup](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i) {
+			mObjectiveValues[i] = setup.objectiveFunction(mPopulation[i]);
+		}
+	};
+	if (setup.parallelEvaluation) {
+		ThreadPool::Instance().Parallel_For(mPopulation.size(), evaluateRange);
+	}
+	else {
+		evaluateRange(0, mPopulation.size());
+	}
+}
+
+void SteadyStateGeneticAlgorithm::Update_Best() {
+	const auto best = std::min_element(mObjectiveValues.begin(), mObjectiveValues.end());
+	mBestMetric = *best;
+	mBest = mPopulation[static_cast<size_t>(std::distance(mObjectiveValues.begin(), best))];
+}
+
+bool SteadyStateGeneticAlgorithm::Promote(const TOptimizer_Setup& setup, double coarseValue) {
+	// an offspring about to become the best one is promoted too, the best solution must not be a coarse estimate
+	mPromotion_Scratch = mCoarse_Window;
+	const bool promote = coarseValue <= Promotion_Threshold(setup, mPromotion_Scratch) || coarseValue < mBestMetric;
+
+	if (mCoarse_Window.size() < setup.populationSize) {
+		mCoarse_Window.push_back(coarseValue);
+	}
+	else {
+		mCoarse_Window[mCoarse_Window_Next] = coarseValue;
+		mCoarse_Window_Next = (mCoarse_Window_Next + 1) % mCoarse_Window.size();
+	}
+
+	return promote;
+}
+
+void SteadyStateGeneticAlgorithm::On_Iteration_Done(const TOptimizer_Setup& setup, std::unique_lock<std::mutex>& lock, TCallback_Gate& callbackGate, size_t iteration, bool budgetExhausted) {
+	// the workers breed from the population concurrently, so there are no restarts - any stagnation stops the search
+	const bool stopping = budgetExhausted || mStagnation.Update(setup, mBestMetric, mPopulation) != NStagnation_Action::None;
+
+	// the final state is always delivered when stopping early
+	if (callbackGate.Should_Deliver(iteration, mBestMetric) || (stopping && setup.callbackFunction)) {
+		TPerf_Scope callbackScope(NPerf_Counter::Callback);
+
+		std::vector<size_t> indices(mPopulation.size());
+		for (size_t i = 0; i < indices.size(); ++i) {
+			indices[i] = i;
+		}
+		std::sort(indices.begin(), indices.end(), [this](size_t a, size_t b) {
+			return mObjectiveValues[a] < mObjectiveValues[b];
+		});
+
+		std::vector<std::vector<double>> sortedPopulation(indices.size());
+		for (size_t i = 0; i < indices.size(); ++i) {
+			sortedPopulation[i] = mPopulation[indices[i]];
+		}
+		const double bestMetric = mBestMetric;
+
+		// the callback is called without the lock, but the other workers wait until it returns (e.g., stepped mode)
+		mCallback_Running = true;
+		lock.unlock();
+
+		NAction action = NAction::Continue;
+		try {
+			action = setup.callbackFunction(NCallback_Stage::After, iteration, bestMetric, sortedPopulation);
+		}
+		catch (...) {
+			lock.lock();
+			mCallback_Running = false;
+			mFinished = true;
+			mCallback_Cv.notify_all();
+			throw;
+		}
+
+		lock.lock();
+		mCallback_Running = false;
+		mCallback_Cv.notify_all();
+
+		// a worker may have stopped the search meanwhile (stop requested)
+		if (mFinished) {
+			return;
+		}
+
+		if (action == NAction::Abort) {
+			mFinished = true;
+			Emit_Checkpoint(setup);
+			return;
+		}
+	}
+
+	if (stopping || iteration + 1 >= setup.maxIterations) {
+		mFinished = true;
+		return;
+	}
+
+	if (setup.checkpointFunction && std::chrono::steady_clock::now() - mLast_Checkpoint >= setup.checkpointInterval) {
+		Emit_Checkpoint(setup);
+		mLast_Checkpoint = std::chrono::steady_clock::now();
+	}
+}
+
+void SteadyStateGeneticAlgorithm::Wait_For_Callback(const TOptimizer_Setup& setup, std::unique_lock<std::mutex>& lock) {
+	mCallback_Cv.wait(lock, setup.stopToken, [this]() {
+		return !mCallback_Running;
+	});
+}
+
+void SteadyStateGeneticAlgorithm::Worker_Run(const TOptimizer_Setup& setup, TCallback_Gate& callbackGate, const TBudget& budget) {
+	std::vector<double> offspring(setup.lowerBounds.size());
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true) {
+		Wait_For_Callback(setup, lock);
+		if (mFinished) {
+			break;
+		}
+
+		if (setup.stopToken.stop_requested()) {
+			mFinished = true;
+			Emit_Checkpoint(setup);
+			break;
+		}
+
+		if (!Breed(setup, offspring)) {
+			continue;
+		}
+		// data revision the parents' objective values were measured on
+		const uint64_t breedRevision = mData_Revision;
+
+		// evaluate outside the lock, the other workers keep breeding and inserting meanwhile
+		lock.unlock();
+		double value = setup.coarseObjectiveFunction ? setup.coarseObjectiveFunction(offspring) : setup.objectiveFunction(offspring);
+		lock.lock();
+
+		if (mFinished) {
+			break;
+		}
+
+		bool coarseOnly = setup.coarseObjectiveFunction != nullptr;
+		if (coarseOnly && Promote(setup, value)) {
+			coarseOnly = false;
+			lock.unlock();
+			value = setup.objectiveFunction(offspring);
+			lock.lock();
+
+			if (mFinished) {
+				break;
+			}
+		}
+
+		Wait_For_Callback(setup, lock);
+		// finished, or woken by the stop request while the callback still runs (handled at the top of the loop)
+		if (mFinished || mCallback_Running) {
+			continue;
+		}
+
+		// the data changed since the parents were evaluated - the population values (and maybe the offspring's) are stale;
+		// the population is re-evaluated with the lock held, so no worker breeds from (or inserts into) it meanwhile
+		if (Data_Changed(setup)) {
+			Evaluate_Population(setup);
+			Update_Best();
+			mCoarse_Window.clear();
+			mCoarse_Window_Next = 0;
+			continue;
+		}
+		if (breedRevision != mData_Revision) {
+			continue;
+		}
+
+		Insert(offspring, value, coarseOnly);
+		mEvaluations++;
+
+		// the initial population counts towards the evaluation budget too
+		const bool budgetExhausted = budget.Exhausted(setup.populationSize + mEvaluations, mBestMetric);
+		if (budgetExhausted || mEvaluations % setup.populationSize == 0) {
+			On_Iteration_Done(setup, lock, callbackGate, (mEvaluations - 1) / setup.populationSize, budgetExhausted);
+		}
+	}
+}
+
+void SteadyStateGeneticAlgorithm::Save_State(TBinary_Writer& writer) const {
+	Save_Base_State(writer);
+	mGaussian.Save(writer);
+	writer.Write<uint64_t>(mEvaluations);
+	mStagnation.Save(writer);
+}
+
+bool SteadyStateGeneticAlgorithm::Load_State(const TOptimizer_Setup& setup) {
+	TBinary_Reader reader(setup.resumeState);
+
+	uint64_t evaluations = 0;
+	if (!Load_Base_State(reader, setup.lowerBounds.size()) || mPopulation.size() != setup.populationSize || !mGaussian.Load(reader) || !reader.Read(evaluations) || !mStagnation.Load(reader)) {
+		return false;
+	}
+	mEvaluations = static_cast<size_t>(evaluations);
+
+	return reader.At_End();
+}
+
+void SteadyStateGeneticAlgorithm::Emit_Checkpoint(const TOptimizer_Setup& setup) const {
+	if (!setup.checkpointFunction) {
+		return;
+	}
+
+	TRACE_SCOPE("SSGA::Checkpoint");
+
+	TBinary_Writer writer;
+	Save_State(writer);
+	setup.checkpointFunction(writer.Take());
+}
+
+void SteadyStateGeneticAlgorithm::Optimize(const TOptimizer_Setup& setup, std::vector<double>& bestParameters, double& bestMetric) {
+	if (setup.populationSize < 2 || setup.lowerBounds.size() != setup.upperBounds.size() || setup.lowerBounds.empty() || setup.objectiveFunction == nullptr) {
+		throw std::invalid_argument("Invalid optimizer setup");
+	}
+
+	// mutation dispersions; sensitivity is not mandatory, fall back to 10.0
+	const size_t paramCount = setup.lowerBounds.size();
+	mMutation_Sigma.clear();
+	for (size_t i = 0; i < paramCount; ++i) {
+		mMutation_Sigma.push_back((i < setup.sensitivity.size() && setup.sensitivity[i] > 0.0) ? setup.sensitivity[i] : 10.0);
+	}
+	mMutation_Skip_Sampler.Set_Probability(mMutationRate);
+	mMutation_Skip = mMutation_Skip_Sampler.Next(mRandGen);
+
+	// the objective sees the full data
+	if (setup.subsetFunction) {
+		setup.subsetFunction(0, 0);
+	}
+
+	mEvaluations = 0;
+	mFinished = false;
+	mStagnation = {};
+	mCoarse_Window.clear();
+	mCoarse_Window_Next = 0;
+	mCoarse_Only.clear();
+
+	// the initial (or resumed) objective values are measured on the current data
+	Data_Changed(setup);
+
+	if (!setup.resumeState.empty()) {
+		if (!Load_State(setup)) {
+			throw std::invalid_argument("Invalid optimizer state to resume from");
+		}
+
+		// the experiment data are stored when the optimization starts, the checkpointed values may have been measured
+		// on data edited later - the population is re-evaluated on the loaded data
+		Evaluate_Population(setup);
+	}
+	else {
+		std::uniform_real_distribution<> dis(0.0, 1.0);
+		mPopulation.assign(setup.populationSize, std::vector<double>(paramCount));
+		for (auto& individual : mPopulation) {
+			for (size_t i = 0; i < paramCount; ++i) {
+				individual[i] = setup.lowerBounds[i] + dis(mRandGen) * (setup.upperBounds[i] - setup.lowerBounds[i]);
+			}
+		}
+		if (setup.initialGuess.size() == paramCount) {
+			mPopulation[0] = setup.initialGuess;
+		}
+
+		// the initial population is the only barrier
+		mObjectiveValues.resize(setup.populationSize);
+		Evaluate_Population(setup);
+	}
+
+	Update_Best();
+
+	if (setup.callbackFunction) {
+		if (setup.callbackFunction(NCallback_Stage::Before, mEvaluations / setup.populationSize, 0, mPopulation) == NAction::Abort) {
+			return;
+		}
+	}
+
+	TCallback_Gate callbackGate(setup);
+	const TBudget budget(setup);
+	mLast_Checkpoint = std::chrono::steady_clock::now();
+
+	if (mEvaluations / setup.populationSize < setup.maxIterations) {
+		// every pool thread runs its own worker loop until the optimization finishes
+		const size_t workerCount = setup.parallelEvaluation ? ThreadPool::Instance().Concurrency() : 1;
+		if (workerCount > 1) {
+			ThreadPool::Instance().Parallel_For(workerCount, [this, &setup, &callbackGate, &budget](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; ++i) {
+					Worker_Run(setup, callbackGate, budget);
+				}
+			});
+		}
+		else {
+			Worker_Run(setup, callbackGate, budget);
+		}
+	}
+
+	bestParameters = mBest;
+	bestMetric = mBestMetric;
+}
@@ -0,0 +1,102 @@
+/**
+ * OptVisualDemo
+ *
+ * Copyright (c) 2025-present, Martin Ubl
+ * Distributed under the MIT license
+ */
+
+#pragma once
+
+#include "../Core/Optimizer.h"
+#include "../Core/Sampling.h"
+
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Asynchronous steady-state genetic algorithm; there is no generation barrier - every worker breeds an offspring,
+ * evaluates it and inserts it into the population (replacing the worst individual) as soon as it is done, so the
+ * workers never wait for the slowest candidate of a generation
+ *
+ * One iteration corresponds to populationSize completed evaluations. The results depend on the timing of the
+ * evaluations, so a resumed run is not identical to an uninterrupted one. Mini-batch evaluation is not supported
+ * (the subset would change under the running evaluations), the full data are evaluated. Stagnation stops the search
+ * even when restarts are requested. With multi-fidelity evaluation, an offspring is promoted to the full fidelity
+ * evaluation when its coarse value ranks in the top promotionFraction of the recent offspring.
+ */
+class SteadyStateGeneticAlgorithm : public Optimizer {
+	private:
+		double mMutationRate = 0.01; // Probability of mutation
+		double mCrossoverRate = 0.7; // Probability of crossover
+
+		// mutation dispersion of each parameter
+		std::vector<double> mMutation_Sigma;
+		// genes to skip before the next mutated one (continues to the next offspring)
+		Sampling::TGeometric_Skip mMutation_Skip_Sampler;
+		size_t mMutation_Skip = 0;
+		Sampling::TGaussian_Batch mGaussian;
+
+		// guards the population, the objective values, the random generator and the state below
+		std::mutex mMutex;
+
+		// completed offspring evaluations
+		size_t mEvaluations = 0;
+		// set when the workers should stop (all iterations done, stopped or aborted)
+		bool mFinished = false;
+		// set while a worker runs the callback (without the lock); the other workers do not change the population meanwhile
+		bool mCallback_Running = false;
+		std::condition_variable_any mCallback_Cv;
+
+		TStagnation_Detector mStagnation;
+
+		// data revision the objective values were measured on (see TOptimizer_Setup::dataRevisionFunction)
+		uint64_t mData_Revision = 0;
+
+		std::vector<double> mBest;
+		double mBestMetric = std::numeric_limits<double>::infinity();
+
+		std::chrono::steady_clock::time_point mLast_Checkpoint;
+
+		// multi-fidelity evaluation buffers
+		std::vector<size_t> mPromoted;
+		std::vector<double> mPromotion_Scratch;
+		// coarse values of the last populationSize offspring (the promotion ranks among them); not part of the checkpoint
+		std::vector<double> mCoarse_Window;
+		size_t mCoarse_Window_Next = 0;
+
+		// checks the data revision; returns true if the data changed since the last check
+		bool Data_Changed(const TOptimizer_Setup& setup);
+		// evaluates the whole population (multi-fidelity, if set up)
+		void Evaluate_Population(const TOptimizer_Setup& setup);
+		// takes the best individual of the population as the best solution
+		void Update_Best();
+
+		// record the coarse value of an offspring, returns true if it should be evaluated at full fidelity
+		bool Promote(const TOptimizer_Setup& setup, double coarseValue);
+
+		// tournament selection
+		size_t Select_Parent();
+		// breed an offspring from the current population; returns false if it is identical to its parent (nothing to evaluate)
+		bool Breed(const TOptimizer_Setup& setup, std::vector<double>& offspring);
+		void Mutate(const TOptimizer_Setup& setup, std::vector<double>& offspring, bool& changed);
+		// replace the worst individual with the offspring, if it is better; coarseOnly = the value is a coarse estimate
+		void Insert(const std::vector<double>& offspring, double value, bool coarseOnly);
+
+		// called by the worker that completed an iteration or exhausted the budget (with the lock held) - callback, checkpoint, termination;
+		// the lock is released while the callback runs
+		void On_Iteration_Done(const TOptimizer_Setup& setup, std::unique_lock<std::mutex>& lock, TCallback_Gate& callbackGate, size_t iteration, bool budgetExhausted);
+		// waits until the running callback (if any) returns, or the stop is requested
+		void Wait_For_Callback(const TOptimizer_Setup& setup, std::unique_lock<std::mutex>& lock);
+
+		void Worker_Run(const TOptimizer_Setup& setup, TCallback_Gate& callbackGate, const TBudget& budget);
+
+		void Save_State(TBinary_Writer& writer) const;
+		bool Load_State(const TOptimizer_Setup& setup);
+		void Emit_Checkpoint(const TOptimizer_Setup& setup) const;
+
+	public:
+		SteadyStateGeneticAlgorithm(double mutationRate = 0.01, double crossoverRate = 0.7)
+			: mMutationRate(mutationRate), mCrossoverRate(crossoverRate) {}
+
+		void Optimize(const TOptimizer_Setup& setup, std::vector<double>& bestParameters, double& bestMetric) override;
+};
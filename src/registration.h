@@ -28,6 +28,7 @@ enum class NExperiment {
 enum class NOptimizer {
 	None,
 	GeneticAlgorithm_Simple,
+	GeneticAlgorithm_SteadyState,
 };
 
 class Experiment;